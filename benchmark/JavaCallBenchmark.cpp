@@ -0,0 +1,205 @@
+// Measures the wrapper's JNI call paths against the fixtures in java/.
+//
+//     jnipp_benchmark [iterations] [filter]
+//
+// Each case is warmed up, then timed over `iterations` calls. Allocations are
+// C++ heap allocations made by the wrapper (operator new), not JVM allocations.
+#include <JNI++.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::atomic<std::size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (auto memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+class Benchmark {
+    std::size_t iterations;
+    std::string filter;
+
+public:
+    Benchmark(std::size_t iterations, std::string filter) : iterations(iterations), filter(std::move(filter)) {
+        std::printf("%-36s %12s %14s\n", "path", "ns/call", "allocs/call");
+    }
+
+    // Runs body iterations times; callsPerRun is the number of JNI calls one run
+    // of body stands for. Local references are dropped every few hundred runs.
+    template <typename Body>
+    void run(const char* name, Body&& body, std::size_t callsPerRun = 1) {
+        if (!filter.empty() && std::string(name).find(filter) == std::string::npos) {
+            return;
+        }
+        constexpr std::size_t chunk = 256;
+        auto runs = std::max<std::size_t>(1, iterations / callsPerRun);
+        for (std::size_t done = 0; done < runs / 10 + 1; done += chunk) {
+            JavaLocalFrame frame(chunk);
+            for (std::size_t i = 0; i < chunk; ++i) {
+                body();
+            }
+        }
+
+        auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        for (std::size_t done = 0; done < runs; done += chunk) {
+            JavaLocalFrame frame(chunk);
+            for (std::size_t i = 0; i < chunk && done + i < runs; ++i) {
+                body();
+            }
+        }
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        auto allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        auto calls = static_cast<double>(runs * callsPerRun);
+        std::printf("%-36s %12.1f %14.2f\n", name, elapsed / calls, static_cast<double>(allocations) / calls);
+    }
+};
+
+struct Record {
+    int64_t time;
+    double value;
+};
+
+template <>
+struct JavaStructSchema<Record> {
+    static constexpr auto fields = std::make_tuple(
+        JavaStructField{"time", &Record::time},
+        JavaStructField{"value", &Record::value});
+};
+
+static jlong ticks = 0;
+
+static void JNICALL nativeTick(JNIEnv*, jobject, jint i) {
+    ticks += i;
+}
+
+int main(int argc, char** argv) {
+    std::size_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string filter = argc > 2 ? argv[2] : "";
+
+    JVM jvm(JVMConfig::production(JNIPP_BENCHMARK_CLASSPATH));
+    auto fixture = jvm.getClass("jnipp.bench.Fixture");
+    auto target = fixture.createNew("", int32_t(7)).share();
+    auto other = fixture.createNew("", int32_t(3)).share();
+    JavaObj fixtureType("jnipp.bench.Fixture");
+    std::string text = "hello";
+    std::vector<float> floats(1024);
+
+    target.registerNativeVoid("tick", &nativeTick, int32_t());
+    fixture.registerNatives(JavaNative<[](int32_t a, int32_t b) { return a + b; }>("nativeAdd"));
+
+    Benchmark benchmark(iterations, filter);
+
+    benchmark.run("static void()", [&] {
+        fixture.callVoid("staticNoop");
+    });
+    benchmark.run("static int(int, int)", [&] {
+        fixture.call("staticAdd", int32_t(), 1, 2);
+    });
+    benchmark.run("static float(float, float)", [&] {
+        fixture.call("staticScale", float(), 1.0f, 2.0f);
+    });
+    constexpr std::size_t batchRows = 1000;
+    std::vector<float> batchResults(batchRows);
+    std::vector<float> batchA(batchRows, 1.0f);
+    std::vector<float> batchB(batchRows, 2.0f);
+    benchmark.run("static float(float, float) callBatch", [&] {
+        fixture.callBatch("staticScaleBatch", batchResults, batchA, batchB);
+    }, batchRows);
+    benchmark.run("instance void()", [&] {
+        target.callVoid("noop");
+    });
+    benchmark.run("instance int(int, int)", [&] {
+        target.call("add", int32_t(), 1, 2);
+    });
+    auto addId = target.getMethodID("add", int32_t(), 1, 2);
+    benchmark.run("instance int(int, int) by jmethodID", [&] {
+        target.call(addId, int32_t(), 1, 2);
+    });
+    auto add = target.bind<int32_t(int32_t, int32_t)>("add");
+    benchmark.run("instance int(int, int) bound", [&] {
+        add(1, 2);
+    });
+    benchmark.run("string argument", [&] {
+        target.callVoid("takeString", text);
+    });
+    auto interned = JavaString::intern(text);
+    benchmark.run("interned string argument", [&] {
+        target.callVoid("takeString", interned);
+    });
+    benchmark.run("string return", [&] {
+        target.call("getString", std::string());
+    });
+    benchmark.run("object argument", [&] {
+        target.callVoid("takeObject", other);
+    });
+    benchmark.run("object return", [&] {
+        target.call("self", fixtureType);
+    });
+    JavaGlobalRef fixtureRef(fixtureType);
+    benchmark.run("object return as JavaGlobalRef", [&] {
+        target.call("self", fixtureRef);
+    });
+    benchmark.run("createNew", [&] {
+        fixture.createNew("", int32_t(1));
+    });
+    benchmark.run("field read int", [&] {
+        target.getField("value", int32_t());
+    });
+    constexpr std::size_t recordCount = 1000;
+    std::vector<Record> records(recordCount, Record{1, 2.0});
+    benchmark.run("struct records through one buffer", [&] {
+        target.call("sumRecords", double(), JavaStruct<Record>::buffer(records));
+    }, recordCount);
+    auto names = target.call("names", JavaObj("java.util.List"), static_cast<int32_t>(recordCount)).share();
+    JavaObj objectType("java.lang.Object");
+    benchmark.run("List element by get(i)", [&] {
+        JavaLocalFrame frame(static_cast<jint>(recordCount));
+        for (int32_t i = 0; i < static_cast<int32_t>(recordCount); ++i) {
+            names.call("get", objectType, i);
+        }
+    }, recordCount);
+    benchmark.run("List<String> element through JavaList", [&] {
+        for (auto& name : JavaList<std::string>(names)) {
+            (void)name;
+        }
+    }, recordCount);
+    benchmark.run("createDirectBuffer", [&] {
+        target.createDirectBuffer(floats);
+    });
+    benchmark.run("linkBuffer", [&] {
+        target.linkBuffer("floats", floats);
+    });
+
+    // Upcalls are driven from Java in batches so the numbers are per native call.
+    constexpr int32_t upcalls = 1000;
+    benchmark.run("native upcall registerNativeVoid", [&] {
+        target.callVoid("runTicks", upcalls);
+    }, upcalls);
+    benchmark.run("native upcall registerNatives", [&] {
+        target.call("runNativeAdds", int32_t(), upcalls);
+    }, upcalls);
+
+#ifdef JNIPP_INSTRUMENTATION
+    JavaInstrumentation::getInstance().writeJson("jnipp-benchmark-stats.json");
+#endif
+    return EXIT_SUCCESS;
+}
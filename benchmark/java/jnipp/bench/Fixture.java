@@ -0,0 +1,97 @@
+package jnipp.bench;
+
+import java.nio.ByteBuffer;
+import java.nio.FloatBuffer;
+import java.util.ArrayList;
+import java.util.List;
+
+// Target of the call path benchmarks; every method does as little as possible
+// so the numbers are dominated by the JNI transition and the wrapper.
+public class Fixture {
+    public int value;
+    public FloatBuffer floats;
+    private long sink;
+
+    public Fixture() {
+    }
+
+    public Fixture(int value) {
+        this.value = value;
+    }
+
+    public static void staticNoop() {
+    }
+
+    public static int staticAdd(int a, int b) {
+        return a + b;
+    }
+
+    public static float staticScale(float a, float b) {
+        return a * b;
+    }
+
+    public static void staticScaleBatch(int rows, FloatBuffer results, FloatBuffer a, FloatBuffer b) {
+        for (int i = 0; i < rows; ++i) {
+            results.put(i, staticScale(a.get(i), b.get(i)));
+        }
+    }
+
+    public void noop() {
+    }
+
+    public int add(int a, int b) {
+        return a + b;
+    }
+
+    public void takeString(String text) {
+        sink += text.length();
+    }
+
+    public String getString() {
+        return "benchmark";
+    }
+
+    public void takeObject(Fixture other) {
+        sink += other.value;
+    }
+
+    public Fixture self() {
+        return this;
+    }
+
+    // Records of the benchmark's Record schema: int64 time at 0, double value
+    // at 8, 16 bytes each, in native order.
+    public double sumRecords(ByteBuffer records) {
+        double sum = 0;
+        for (int offset = 8; offset < records.capacity(); offset += 16) {
+            sum += records.getDouble(offset);
+        }
+        return sum;
+    }
+
+    public List<String> names(int count) {
+        var names = new ArrayList<String>(count);
+        for (int i = 0; i < count; ++i) {
+            names.add("name" + i);
+        }
+        return names;
+    }
+
+    public native void tick(int i);
+
+    public native int nativeAdd(int a, int b);
+
+    public void runTicks(int count) {
+        for (int i = 0; i < count; ++i) {
+            tick(i);
+        }
+    }
+
+    public int runNativeAdds(int count) {
+        int sum = 0;
+        for (int i = 0; i < count; ++i) {
+            sum += nativeAdd(i, 1);
+        }
+        return sum;
+    }
+}
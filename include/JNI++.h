@@ -3,6 +3,25 @@
 #include <jni++/JavaClass.h>
 #include <jni++/JavaObj.h>
 #include <jni++/JVM.h>
+#include <jni++/JVMConfig.h>
+#include <jni++/JavaLocalFrame.h>
+#include <jni++/JavaArray.h>
+#include <jni++/JavaString.h>
+#include <jni++/JavaDirectBuffer.h>
+#include <jni++/JavaNative.h>
+#include <jni++/JavaField.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaInstrumentation.h>
+#include <jni++/JavaWorkerPool.h>
+#include <jni++/JavaBatch.h>
+#include <jni++/JavaCall.h>
+#include <jni++/JavaMethod.h>
+#include <jni++/JavaClassLoader.h>
+#include <jni++/JavaManifest.h>
+#include <jni++/JavaArena.h>
+#include <jni++/JavaStruct.h>
+#include <jni++/JavaRef.h>
+#include <jni++/JavaCollection.h>
 
 class JNI {
 public:
@@ -15,20 +34,41 @@ public:
 	JNI(JNI&&) = delete;
 	
 	JVM& getJVM(std::string classPath, bool verbose) {
-		try {
-			return *jvms.at(classPath).get();
+		return getJVM(JVMConfig::debug(std::move(classPath)).verbose(verbose));
+	}
+
+	// Creates the JVM on the calling thread, unless startJVM() already did so
+	// for this classpath; then waits for that one.
+	JVM& getJVM(const JVMConfig& config) {
+		std::shared_future<std::unique_ptr<JVM>> started;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			auto& jvm = jvms[config.getClassPath()];
+			if (!jvm.valid()) {
+				std::promise<std::unique_ptr<JVM>> created;
+				created.set_value(std::make_unique<JVM>(config));
+				jvm = created.get_future().share();
+			}
+			started = jvm;
 		}
-		catch (std::out_of_range) {
-			auto jvm = std::make_unique<JVM>(classPath, verbose);
-			auto jvmPtr = jvm.get();
-			jvms[classPath] = std::move(jvm);
-			return *jvmPtr;
+		return *started.get();
+	}
+
+	// Starts the JVM of config's classpath in the background (see JVM::start)
+	// and returns at once; getJVM() with the same classpath waits for it.
+	std::shared_future<std::unique_ptr<JVM>> startJVM(const JVMConfig& config) {
+		std::lock_guard<std::mutex> lock(mutex);
+		auto& jvm = jvms[config.getClassPath()];
+		if (!jvm.valid()) {
+			jvm = JVM::start(config).share();
 		}
+		return jvm;
 	}
 private:
 	JNI() = default;
 
-	std::map<std::string, std::unique_ptr<JVM>> jvms;
+	std::mutex mutex;
+	std::map<std::string, std::shared_future<std::unique_ptr<JVM>>> jvms;
 };
 
 
@@ -1,74 +1,180 @@
 #pragma once
 #include <jni.h>
 #include <jni++/JavaClass.h>
+#include <jni++/JavaClassLoader.h>
+#include <jni++/JavaDirectBuffer.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaManifest.h>
+#include <jni++/JVMConfig.h>
 
 #include <string>
 #include <vector>
+#include <future>
 #include <memory>
-#include <map>
+#include <mutex>
+#include <stdexcept>
 
+// A classpath in the process-wide JVM. HotSpot runs one JVM per process: the
+// first JVM object creates it from its JVMConfig, with its classpath as the
+// system classpath. Every later one, while the first is still alive, shares
+// that JVM and gets its own JavaClassLoader instead (the launch options of
+// its config are then ignored). The JVM is destroyed with the last JVM object.
 class JVM {
-    JNIEnv* env;
-    JavaVM* jvm;
-    std::map<std::string, std::unique_ptr<JavaClass>> classesCache;
+	// The running JVM, shared by every JVM object.
+	class Machine {
+		JavaVM* jvm;
+
+	public:
+		explicit Machine(const JVMConfig& config) {
+			auto optionStrings = config.getOptions();
+			std::vector<JavaVMOption> options(optionStrings.size());
+			for (std::size_t i = 0; i < options.size(); ++i) {
+				options[i].optionString = const_cast<char*>(optionStrings[i].c_str());
+				options[i].extraInfo = nullptr;
+			}
+
+			JavaVMInitArgs vm_args;
+			vm_args.version = config.getVersion();
+			vm_args.nOptions = static_cast<jint>(options.size());
+			vm_args.options = options.data();
+			vm_args.ignoreUnrecognized = config.getIgnoreUnrecognized();
+			JNIEnv* env;
+			if (JNI_OK != JNI_CreateJavaVM(&jvm, reinterpret_cast<void**>(&env), &vm_args)) {
+				throw std::runtime_error("JVM Creation failed");
+			}
+			JavaEnv::bind(env);
+		}
+
+		Machine(Machine const&) = delete;
+		Machine& operator=(Machine const&) = delete;
+
+		// The environment comes from the JVM rather than the thread-local cache,
+		// which is gone when this runs from a static destructor at exit.
+		// Without one (the thread cannot attach) the global references are
+		// left to DestroyJavaVM.
+		~Machine() {
+			auto env = JavaEnv::attached();
+			if (env == nullptr && jvm->AttachCurrentThread(reinterpret_cast<void**>(&env), nullptr) != JNI_OK) {
+				env = nullptr;
+			}
+			if (env != nullptr) {
+				JavaString::clearInterned(env);
+				JavaDirectBufferPool::getInstance().clear(env);
+				JavaClassRegistry::getInstance().clear(env);
+			}
+			JavaEnv::unbind();
+			jvm->DestroyJavaVM();
+		}
+	};
+
+	std::shared_ptr<Machine> machine;
+	std::unique_ptr<JavaClassLoader> loader;
+	std::unique_ptr<JavaManifest> manifest;
+	std::string manifestPath;
 
 public:
-	JVM(std::string libPath, bool verbose) {
-		libPath.insert(0, "-Djava.class.path=");
-		std::vector<char> zstring(libPath.length() + 1);
-		std::copy(libPath.begin(), libPath.end(), zstring.begin());
-        
-        std::vector<JVMOption> options;
-        options.emplace_back(zstring.data());
-		options.emplace_back("-XX:+CreateMinidumpOnCrash");
-        options.emplace_back("-Djava.compiler=NONE");
-        options.emplace_back("-Xcheck:jni");
-		//options.emplace_back("-Xdebug");
-		//options.emplace_back("-Xrunjdwp:transport=dt_socket,server=y,suspend=n,address=5005");
-		 
-		if (verbose) options.emplace_back("-verbose:jni");
-
-        JavaVMInitArgs vm_args;
-        vm_args.version = JNI_VERSION_1_6;
-		vm_args.nOptions = static_cast<jint>(options.size());
-		vm_args.options = reinterpret_cast<JavaVMOption*>(options.data());
-		vm_args.ignoreUnrecognized = false;
-		if (JNI_OK != JNI_CreateJavaVM(&jvm, reinterpret_cast<void**>(&env), &vm_args)) {
-			throw std::runtime_error("JVM Creation failed");
+	JVM(std::string libPath, bool verbose) : JVM(JVMConfig::debug(std::move(libPath)).verbose(verbose)) {
+	}
+
+	explicit JVM(const JVMConfig& config) {
+		{
+			std::lock_guard<std::mutex> lock(machineMutex());
+			machine = runningMachine().lock();
+			if (machine) {
+				loader = std::make_unique<JavaClassLoader>(config.getClassPath(), JavaEnv::get());
+			} else {
+				machine = std::make_shared<Machine>(config);
+				runningMachine() = machine;
+			}
+		}
+		if (!config.getPrewarmManifest().empty() || !config.getRecordManifest().empty()) {
+			manifest = std::make_unique<JavaManifest>();
+			if (!config.getPrewarmManifest().empty()) {
+				manifest->read(config.getPrewarmManifest());
+				getRegistry().prewarm(*manifest, JavaEnv::get());
+			}
+			if (config.getRecordManifest().empty()) {
+				manifest.reset();
+			} else {
+				manifestPath = config.getRecordManifest();
+				getRegistry().record(manifest.get());
+			}
 		}
 	}
 
-	~JVM() { jvm->DestroyJavaVM(); }
+	// Creates the JVM on a background thread, prewarming included, while the
+	// caller goes on with its own initialization.
+	static std::future<std::unique_ptr<JVM>> start(JVMConfig config) {
+		return std::async(std::launch::async, [config = std::move(config)] {
+			auto jvm = std::make_unique<JVM>(config);
+			JavaEnv::detachOnExit();
+			return jvm;
+		});
+	}
+
+	JVM(JVM const&) = delete;
+	JVM& operator=(JVM const&) = delete;
+
+	~JVM() {
+		if (manifest) {
+			getRegistry().record(nullptr);
+			try {
+				manifest->write(manifestPath);
+			} catch (const std::exception&) {
+				// Only a prewarming hint; losing it must not take the process down.
+			}
+		}
+		std::lock_guard<std::mutex> lock(machineMutex());
+		loader.reset();
+		machine.reset();
+	}
 
 	template<typename T> auto CheckPointer(std::string cause, T* pointer) -> T* {
 		if (pointer == nullptr) {
-			env->ExceptionClear();
+			JavaEnv::get()->ExceptionClear();
 			throw std::runtime_error(cause + " not found");
 		}
 		return pointer;
 	}
 
-	JavaClass& getClass(std::string classPath) {
-		try {
-			return *classesCache.at(classPath).get();
+	JavaClass getClass(std::string classPath) {
+		if (loader) {
+			return loader->getClass(std::move(classPath));
 		}
-		catch (std::out_of_range) {
-            auto cachedClass = std::make_unique<JavaClass>(classPath, env);
-            auto jClassPtr = cachedClass.get();
-			classesCache[classPath] = std::move(cachedClass);
-			return *jClassPtr;
+		return JavaClass(std::move(classPath), JavaEnv::get());
+	}
+
+	// An unbound JavaObj of a class of this classpath, to pass as a return or field type.
+	JavaObj getType(std::string classPath) {
+		if (loader) {
+			return loader->getType(std::move(classPath));
 		}
+		return JavaObj(std::move(classPath));
+	}
+
+	// The class loader of this classpath; nullptr for the system classpath.
+	JavaClassLoader* getClassLoader() const {
+		return loader.get();
 	}
 
+	// The classes resolved through this JVM object.
+	JavaClassRegistry& getRegistry() const {
+		return loader ? loader->getRegistry() : JavaClassRegistry::getInstance();
+	}
+
+    // Environment of the calling thread, attaching it to the JVM if needed.
     JNIEnv* getEnv() {
-        return env;
+        return JavaEnv::get();
     }
 
 private:
-    struct JVMOption {
-        JVMOption(const char optionString[]) { this->optionString = optionString; }
-        const char* optionString;
-        void *extraInfo;
-    };
-};
+	static std::mutex& machineMutex() {
+		static std::mutex mutex;
+		return mutex;
+	}
 
+	static std::weak_ptr<Machine>& runningMachine() {
+		static std::weak_ptr<Machine> machine;
+		return machine;
+	}
+};
@@ -0,0 +1,205 @@
+#pragma once
+#include <jni.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Launch options for the embedded JVM. Start from one of the profiles and
+// adjust with the chained setters:
+//
+//     JVM jvm(JVMConfig::production("app.jar").maxHeap("2g").sharedArchive("app.jsa"));
+//
+// debug() reproduces the historical defaults: interpreter only, -Xcheck:jni
+// and a minidump on crash. production() keeps the JIT enabled and turns on
+// class data sharing so startup maps pre-parsed classes instead of loading them.
+class JVMConfig {
+public:
+    enum class Compiler {
+        Default,
+        Interpreted,
+        C1Only,
+        Tiered
+    };
+
+    enum class GarbageCollector {
+        Default,
+        Serial,
+        Parallel,
+        G1,
+        Z,
+        Shenandoah,
+        Epsilon
+    };
+
+    static JVMConfig debug(std::string classPath) {
+        JVMConfig config(std::move(classPath));
+        config.checkJni = true;
+        config.minidumpOnCrash = true;
+        config.jit = Compiler::Interpreted;
+        return config;
+    }
+
+    static JVMConfig production(std::string classPath) {
+        JVMConfig config(std::move(classPath));
+        config.jit = Compiler::Tiered;
+        config.classDataSharing = true;
+        config.perfData = false;
+        return config;
+    }
+
+    JVMConfig& verbose(bool enabled) {
+        verboseJni = enabled;
+        return *this;
+    }
+
+    JVMConfig& compiler(Compiler mode) {
+        jit = mode;
+        return *this;
+    }
+
+    JVMConfig& reservedCodeCache(std::string size) {
+        codeCacheSize = std::move(size);
+        return *this;
+    }
+
+    JVMConfig& initialHeap(std::string size) {
+        initialHeapSize = std::move(size);
+        return *this;
+    }
+
+    JVMConfig& maxHeap(std::string size) {
+        maxHeapSize = std::move(size);
+        return *this;
+    }
+
+    JVMConfig& garbageCollector(GarbageCollector collector) {
+        gc = collector;
+        return *this;
+    }
+
+    // Maps the given CDS/AppCDS archive at startup; implies class data sharing.
+    JVMConfig& sharedArchive(std::string path) {
+        sharedArchiveFile = std::move(path);
+        classDataSharing = true;
+        return *this;
+    }
+
+    // Writes a dynamic AppCDS archive of the classes loaded by this run when
+    // the JVM exits (JDK 13+), to be passed to sharedArchive() next time.
+    JVMConfig& archiveClassesAtExit(std::string path) {
+        archiveAtExitFile = std::move(path);
+        return *this;
+    }
+
+    JVMConfig& checkJniCalls(bool enabled) {
+        checkJni = enabled;
+        return *this;
+    }
+
+    // Resolves the classes and members listed in a JavaManifest file right
+    // after startup, before the JVM is handed out. A missing file is ignored.
+    JVMConfig& prewarm(std::string manifestPath) {
+        prewarmManifestFile = std::move(manifestPath);
+        return *this;
+    }
+
+    // Records every class and member resolved through this JVM, plus what
+    // prewarm() loaded, and writes them to path when the JVM object goes away.
+    JVMConfig& recordManifest(std::string path) {
+        recordManifestFile = std::move(path);
+        return *this;
+    }
+
+    // Appends a raw -X/-XX/-D option after the generated ones.
+    JVMConfig& option(std::string value) {
+        extraOptions.push_back(std::move(value));
+        return *this;
+    }
+
+    JVMConfig& ignoreUnrecognized(bool enabled) {
+        ignoreUnrecognizedOptions = enabled;
+        return *this;
+    }
+
+    const std::string& getClassPath() const {
+        return classPath;
+    }
+
+    jint getVersion() const {
+        return version;
+    }
+
+    bool getIgnoreUnrecognized() const {
+        return ignoreUnrecognizedOptions;
+    }
+
+    const std::string& getPrewarmManifest() const {
+        return prewarmManifestFile;
+    }
+
+    const std::string& getRecordManifest() const {
+        return recordManifestFile;
+    }
+
+    std::vector<std::string> getOptions() const {
+        std::vector<std::string> options;
+        options.push_back("-Djava.class.path=" + classPath);
+        if (minidumpOnCrash) options.push_back("-XX:+CreateMinidumpOnCrash");
+        if (checkJni) options.push_back("-Xcheck:jni");
+        if (verboseJni) options.push_back("-verbose:jni");
+
+        switch (jit) {
+        case Compiler::Interpreted: options.push_back("-Xint"); break;
+        case Compiler::C1Only: options.push_back("-XX:TieredStopAtLevel=1"); break;
+        case Compiler::Tiered: options.push_back("-XX:+TieredCompilation"); break;
+        case Compiler::Default: break;
+        }
+        if (!codeCacheSize.empty()) options.push_back("-XX:ReservedCodeCacheSize=" + codeCacheSize);
+
+        if (!initialHeapSize.empty()) options.push_back("-Xms" + initialHeapSize);
+        if (!maxHeapSize.empty()) options.push_back("-Xmx" + maxHeapSize);
+        switch (gc) {
+        case GarbageCollector::Serial: options.push_back("-XX:+UseSerialGC"); break;
+        case GarbageCollector::Parallel: options.push_back("-XX:+UseParallelGC"); break;
+        case GarbageCollector::G1: options.push_back("-XX:+UseG1GC"); break;
+        case GarbageCollector::Z: options.push_back("-XX:+UseZGC"); break;
+        case GarbageCollector::Shenandoah: options.push_back("-XX:+UseShenandoahGC"); break;
+        case GarbageCollector::Epsilon:
+            options.push_back("-XX:+UnlockExperimentalVMOptions");
+            options.push_back("-XX:+UseEpsilonGC");
+            break;
+        case GarbageCollector::Default: break;
+        }
+
+        if (classDataSharing) options.push_back("-Xshare:auto");
+        if (!sharedArchiveFile.empty()) options.push_back("-XX:SharedArchiveFile=" + sharedArchiveFile);
+        if (!archiveAtExitFile.empty()) options.push_back("-XX:ArchiveClassesAtExit=" + archiveAtExitFile);
+        if (!perfData) options.push_back("-XX:-UsePerfData");
+
+        options.insert(options.end(), extraOptions.begin(), extraOptions.end());
+        return options;
+    }
+
+private:
+    explicit JVMConfig(std::string classPath) : classPath(std::move(classPath)) {
+    }
+
+    std::string classPath;
+    jint version = JNI_VERSION_1_6;
+    bool verboseJni = false;
+    bool checkJni = false;
+    bool minidumpOnCrash = false;
+    bool classDataSharing = false;
+    bool perfData = true;
+    bool ignoreUnrecognizedOptions = false;
+    Compiler jit = Compiler::Default;
+    GarbageCollector gc = GarbageCollector::Default;
+    std::string codeCacheSize;
+    std::string initialHeapSize;
+    std::string maxHeapSize;
+    std::string sharedArchiveFile;
+    std::string archiveAtExitFile;
+    std::string prewarmManifestFile;
+    std::string recordManifestFile;
+    std::vector<std::string> extraOptions;
+};
@@ -0,0 +1,240 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaObj.h>
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+// Memory of a JavaArena handed out by allocate(): a C++ span plus where it
+// lies in the arena's ByteBuffer, in bytes.
+template <typename T>
+class JavaArenaSlice {
+    T* data_;
+    std::size_t count;
+    std::size_t byteOffset;
+
+public:
+    JavaArenaSlice(T* data, std::size_t count, std::size_t byteOffset) : data_(data), count(count), byteOffset(byteOffset) {
+    }
+
+    T* data() const {
+        return data_;
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    std::span<T> span() const {
+        return std::span<T>(data_, count);
+    }
+
+    // Arguments for the Java side, which reads the slice with absolute
+    // accessors of the arena buffer: buffer.getFloat(offset + 4 * i).
+    int32_t offset() const {
+        return static_cast<int32_t>(byteOffset);
+    }
+
+    int32_t bytes() const {
+        return static_cast<int32_t>(count * sizeof(T));
+    }
+};
+
+// A bump allocator over one block of native memory that Java sees once, as a
+// single native-order direct ByteBuffer (and, on JDK 22+, a MemorySegment).
+// Allocations are slices of it passed to Java as (offset, length), so no Java
+// object is created per allocation; reset() or a Scope frees them all at once.
+//
+//     JavaArena arena(1 << 20);
+//     processor.callVoid("attach", arena.buffer());
+//     for (auto& request : requests) {
+//         JavaArena::Scope scope(arena);
+//         auto prices = arena.allocate<float>(request.size());
+//         ...
+//         processor.callVoid("price", prices.offset(), static_cast<int32_t>(prices.size()));
+//     }
+//
+// An arena is not thread-safe: use one per thread or per request.
+class JavaArena {
+    struct Free {
+        void operator()(std::byte* memory) const {
+            ::operator delete(memory, std::align_val_t(alignment));
+        }
+    };
+
+    std::unique_ptr<std::byte, Free> memory;
+    std::size_t capacity;
+    std::size_t used = 0;
+    jobject byteBuffer = nullptr;
+    jobject memorySegment = nullptr;
+    bool segmentLookedUp = false;
+
+public:
+    static constexpr std::size_t alignment = 64;
+
+    // A Java ByteBuffer holds at most 2^31 - 1 bytes.
+    explicit JavaArena(std::size_t bytes, JNIEnv* env = JavaEnv::get()) : memory(allocateMemory(bytes)), capacity(bytes) {
+        byteBuffer = createBuffer(env);
+    }
+
+    JavaArena(JavaArena const&) = delete;
+    JavaArena& operator=(JavaArena const&) = delete;
+
+    ~JavaArena() {
+        if (auto env = JavaEnv::tryGet()) {
+            env->DeleteGlobalRef(byteBuffer);
+            if (memorySegment != nullptr) {
+                env->DeleteGlobalRef(memorySegment);
+            }
+        }
+    }
+
+    // Bump-allocates count default-initialized values aligned for T; throws
+    // std::bad_alloc when the arena is full.
+    template <typename T>
+    JavaArenaSlice<T> allocate(std::size_t count) {
+        static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "arena memory is shared with Java and freed without destructors");
+        auto offset = (used + alignof(T) - 1) / alignof(T) * alignof(T);
+        if (offset > capacity || count > (capacity - offset) / sizeof(T)) {
+            throw std::bad_alloc();
+        }
+        used = offset + count * sizeof(T);
+        auto data = reinterpret_cast<T*>(memory.get() + offset);
+        std::uninitialized_default_construct_n(data, count);
+        return JavaArenaSlice<T>(data, count, offset);
+    }
+
+    // Copies values into a new slice.
+    template <typename T>
+    JavaArenaSlice<T> copy(std::span<const T> values) {
+        auto slice = allocate<T>(values.size());
+        std::copy(values.begin(), values.end(), slice.data());
+        return slice;
+    }
+
+    // Position to rewind() back to, releasing everything allocated after it.
+    std::size_t mark() const {
+        return used;
+    }
+
+    void rewind(std::size_t position) {
+        used = position < used ? position : used;
+    }
+
+    void reset() {
+        used = 0;
+    }
+
+    std::size_t size() const {
+        return used;
+    }
+
+    std::size_t getCapacity() const {
+        return capacity;
+    }
+
+    // Rewinds the arena to where it was when the scope was entered.
+    class Scope {
+        JavaArena& arena;
+        std::size_t position;
+
+    public:
+        explicit Scope(JavaArena& arena) : arena(arena), position(arena.mark()) {
+        }
+
+        Scope(Scope const&) = delete;
+        Scope& operator=(Scope const&) = delete;
+
+        ~Scope() {
+            arena.rewind(position);
+        }
+    };
+
+    // The whole arena as a native-order java.nio.ByteBuffer, owned by the arena.
+    JavaObj buffer() const {
+        return JavaObj(JavaClassRegistry::getInstance().get("java/nio/ByteBuffer"), byteBuffer, JavaEnv::get());
+    }
+
+    jobject getBuffer() const {
+        return byteBuffer;
+    }
+
+    // The whole arena as a java.lang.foreign.MemorySegment (MemorySegment.ofBuffer),
+    // owned by the arena; nullptr when the JVM has no foreign memory API.
+    jobject getSegment(JNIEnv* env = JavaEnv::get()) {
+        if (segmentLookedUp) {
+            return memorySegment;
+        }
+        segmentLookedUp = true;
+        auto& registry = JavaClassRegistry::getInstance();
+        auto& segmentClass = registry.get("java/lang/foreign/MemorySegment");
+        auto segmentClassId = registry.resolve(segmentClass, env);
+        if (segmentClassId == nullptr) {
+            env->ExceptionClear();
+            return nullptr;
+        }
+        auto ofBuffer = segmentClass.methods.get("ofBuffer", "(Ljava/nio/Buffer;)Ljava/lang/foreign/MemorySegment;", [&] {
+            return env->GetStaticMethodID(segmentClassId, "ofBuffer", "(Ljava/nio/Buffer;)Ljava/lang/foreign/MemorySegment;");
+        });
+        if (ofBuffer == nullptr) {
+            env->ExceptionClear();
+            return nullptr;
+        }
+        auto segment = env->CallStaticObjectMethod(segmentClassId, ofBuffer, byteBuffer);
+        JavaException::check("JavaArena MemorySegment.ofBuffer", env);
+        memorySegment = env->NewGlobalRef(segment);
+        env->DeleteLocalRef(segment);
+        return memorySegment;
+    }
+
+private:
+    static std::byte* allocateMemory(std::size_t bytes) {
+        if (bytes > static_cast<std::size_t>(INT_MAX)) {
+            throw std::length_error("JavaArena: a direct ByteBuffer holds at most 2^31 - 1 bytes");
+        }
+        return static_cast<std::byte*>(::operator new(bytes == 0 ? 1 : bytes, std::align_val_t(alignment)));
+    }
+
+    jobject createBuffer(JNIEnv* env) {
+        auto& registry = JavaClassRegistry::getInstance();
+        auto& byteBufferClass = registry.get("java/nio/ByteBuffer");
+        auto& byteOrderClass = registry.get("java/nio/ByteOrder");
+        auto byteBufferClassId = registry.resolve(byteBufferClass, env);
+        auto byteOrderClassId = byteBufferClassId == nullptr ? nullptr : registry.resolve(byteOrderClass, env);
+        JavaException::check("JavaArena FindClass", env);
+        auto nativeOrder = byteOrderClass.methods.get("nativeOrder", "()Ljava/nio/ByteOrder;", [&] {
+            return env->GetStaticMethodID(byteOrderClassId, "nativeOrder", "()Ljava/nio/ByteOrder;");
+        });
+        auto order = nativeOrder == nullptr ? nullptr : byteBufferClass.methods.get("order", "(Ljava/nio/ByteOrder;)Ljava/nio/ByteBuffer;", [&] {
+            return env->GetMethodID(byteBufferClassId, "order", "(Ljava/nio/ByteOrder;)Ljava/nio/ByteBuffer;");
+        });
+        JavaException::check("JavaArena GetMethodID", env);
+
+        auto buffer = env->NewDirectByteBuffer(memory.get(), static_cast<jlong>(capacity));
+        JavaException::check("JavaArena NewDirectByteBuffer", env);
+        if (buffer == nullptr) {
+            throw std::runtime_error("JavaArena: the JVM does not support direct buffer access");
+        }
+        auto byteOrder = env->CallStaticObjectMethod(byteOrderClassId, nativeOrder);
+        if (byteOrder != nullptr) {
+            env->DeleteLocalRef(env->CallObjectMethod(buffer, order, byteOrder));
+            env->DeleteLocalRef(byteOrder);
+        }
+        if (env->ExceptionCheck()) {
+            env->DeleteLocalRef(buffer);
+            JavaException::check("JavaArena ByteBuffer.order", env);
+        }
+        auto global = env->NewGlobalRef(buffer);
+        env->DeleteLocalRef(buffer);
+        return global;
+    }
+};
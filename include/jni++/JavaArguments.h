@@ -0,0 +1,39 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaType.h>
+#include <array>
+#include <cstddef>
+
+// The jvalue array for one JNI call. Local references created while
+// marshalling (Java strings built from std::string, for instance) are deleted
+// when the arguments go out of scope, so call loops do not grow the local
+// reference table.
+template <typename... Args>
+class JavaArguments {
+    std::array<jvalue, sizeof...(Args)> values;
+    JNIEnv* env;
+
+public:
+    // env is the environment the local references were created in.
+    JavaArguments(const std::array<jvalue, sizeof...(Args)>& values, JNIEnv* env) : values(values), env(env) {
+    }
+
+    JavaArguments(JavaArguments const&) = delete;
+    JavaArguments& operator=(JavaArguments const&) = delete;
+
+    ~JavaArguments() {
+        if constexpr ((JavaCreatesLocalRef<Args>::value || ...)) {
+            std::size_t index = 0;
+            ((JavaCreatesLocalRef<Args>::value ? env->DeleteLocalRef(values[index++].l) : void(++index)), ...);
+        }
+    }
+
+    jvalue* data() {
+        return values.data();
+    }
+
+    static constexpr std::size_t size() {
+        return sizeof...(Args);
+    }
+};
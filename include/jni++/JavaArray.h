@@ -0,0 +1,228 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaType.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Binds a C++ element type to the matching Java primitive array. The C++ type
+// must have the size and representation of the JNI element type, so spans of
+// it can be handed to the Get/Set<Type>ArrayRegion functions as they are.
+template <typename T>
+struct JavaArrayElement;
+
+template <>
+struct JavaArrayElement<bool> {
+    using NativeType = jboolean;
+    using ArrayType = jbooleanArray;
+    static constexpr JavaFixedString symbol{"[Z"};
+    static constexpr auto newArray = &JNIEnv::NewBooleanArray;
+    static constexpr auto getRegion = &JNIEnv::GetBooleanArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetBooleanArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<int8_t> {
+    using NativeType = jbyte;
+    using ArrayType = jbyteArray;
+    static constexpr JavaFixedString symbol{"[B"};
+    static constexpr auto newArray = &JNIEnv::NewByteArray;
+    static constexpr auto getRegion = &JNIEnv::GetByteArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetByteArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<uint8_t> : JavaArrayElement<int8_t> {
+};
+
+template <>
+struct JavaArrayElement<char16_t> {
+    using NativeType = jchar;
+    using ArrayType = jcharArray;
+    static constexpr JavaFixedString symbol{"[C"};
+    static constexpr auto newArray = &JNIEnv::NewCharArray;
+    static constexpr auto getRegion = &JNIEnv::GetCharArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetCharArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<int16_t> {
+    using NativeType = jshort;
+    using ArrayType = jshortArray;
+    static constexpr JavaFixedString symbol{"[S"};
+    static constexpr auto newArray = &JNIEnv::NewShortArray;
+    static constexpr auto getRegion = &JNIEnv::GetShortArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetShortArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<int32_t> {
+    using NativeType = jint;
+    using ArrayType = jintArray;
+    static constexpr JavaFixedString symbol{"[I"};
+    static constexpr auto newArray = &JNIEnv::NewIntArray;
+    static constexpr auto getRegion = &JNIEnv::GetIntArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetIntArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<int64_t> {
+    using NativeType = jlong;
+    using ArrayType = jlongArray;
+    static constexpr JavaFixedString symbol{"[J"};
+    static constexpr auto newArray = &JNIEnv::NewLongArray;
+    static constexpr auto getRegion = &JNIEnv::GetLongArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetLongArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<float> {
+    using NativeType = jfloat;
+    using ArrayType = jfloatArray;
+    static constexpr JavaFixedString symbol{"[F"};
+    static constexpr auto newArray = &JNIEnv::NewFloatArray;
+    static constexpr auto getRegion = &JNIEnv::GetFloatArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetFloatArrayRegion;
+};
+
+template <>
+struct JavaArrayElement<double> {
+    using NativeType = jdouble;
+    using ArrayType = jdoubleArray;
+    static constexpr JavaFixedString symbol{"[D"};
+    static constexpr auto newArray = &JNIEnv::NewDoubleArray;
+    static constexpr auto getRegion = &JNIEnv::GetDoubleArrayRegion;
+    static constexpr auto setRegion = &JNIEnv::SetDoubleArrayRegion;
+};
+
+// Zero-copy access to a Java primitive array through GetPrimitiveArrayCritical.
+// While it is alive the GC may be held off, so keep the scope short and do not
+// make any other JNI call in it. A const element type releases with JNI_ABORT,
+// which skips the copy-back when the VM had to hand out a copy.
+template <typename T>
+class JavaCriticalArray {
+    JNIEnv* env;
+    jarray array;
+    T* elements;
+    std::size_t length;
+
+public:
+    JavaCriticalArray(jarray array, JNIEnv* env) : env(env), array(array) {
+        length = static_cast<std::size_t>(env->GetArrayLength(array));
+        elements = static_cast<T*>(env->GetPrimitiveArrayCritical(array, nullptr));
+        if (elements == nullptr) {
+            throw std::runtime_error("GetPrimitiveArrayCritical failed");
+        }
+    }
+
+    JavaCriticalArray(JavaCriticalArray const&) = delete;
+    JavaCriticalArray& operator=(JavaCriticalArray const&) = delete;
+
+    ~JavaCriticalArray() {
+        env->ReleasePrimitiveArrayCritical(array, const_cast<std::remove_const_t<T>*>(elements), std::is_const_v<T> ? JNI_ABORT : 0);
+    }
+
+    std::span<T> span() const {
+        return std::span<T>(elements, length);
+    }
+
+    T* data() const {
+        return elements;
+    }
+
+    std::size_t size() const {
+        return length;
+    }
+
+    T* begin() const {
+        return elements;
+    }
+
+    T* end() const {
+        return elements + length;
+    }
+
+    T& operator[](std::size_t index) const {
+        return elements[index];
+    }
+};
+
+// Handle on a Java primitive array (int[], float[], ...). Used as an argument
+// it is passed by reference; used as a return type tag it yields a view on the
+// returned array, which is only copied when read() or toVector() is asked for.
+template <typename T>
+class JavaArray {
+    using Element = JavaArrayElement<T>;
+    using ArrayType = typename Element::ArrayType;
+    using NativeType = typename Element::NativeType;
+
+    static_assert(sizeof(T) == sizeof(NativeType), "element type does not match its Java primitive");
+
+    ArrayType array = nullptr;
+
+public:
+    JavaArray() = default;
+
+    explicit JavaArray(jobject array) : array(static_cast<ArrayType>(array)) {
+    }
+
+    static JavaArray create(std::size_t size) {
+        auto env = JavaEnv::get();
+        return JavaArray((env->*Element::newArray)(static_cast<jsize>(size)));
+    }
+
+    static JavaArray from(std::span<const T> values) {
+        auto result = create(values.size());
+        result.write(0, values);
+        return result;
+    }
+
+    jobject getObjId() const {
+        return array;
+    }
+
+    std::size_t size() const {
+        return static_cast<std::size_t>(JavaEnv::get()->GetArrayLength(array));
+    }
+
+    // Copies elements [offset, offset + out.size()) into out.
+    void read(std::size_t offset, std::span<T> out) const {
+        auto env = JavaEnv::get();
+        (env->*Element::getRegion)(array, static_cast<jsize>(offset), static_cast<jsize>(out.size()), reinterpret_cast<NativeType*>(out.data()));
+    }
+
+    // Copies values into the array starting at offset.
+    void write(std::size_t offset, std::span<const T> values) {
+        auto env = JavaEnv::get();
+        (env->*Element::setRegion)(array, static_cast<jsize>(offset), static_cast<jsize>(values.size()), reinterpret_cast<const NativeType*>(values.data()));
+    }
+
+    std::vector<T> toVector() const {
+        std::vector<T> values(size());
+        read(0, values);
+        return values;
+    }
+
+    JavaCriticalArray<T> critical() {
+        return JavaCriticalArray<T>(array, JavaEnv::get());
+    }
+
+    JavaCriticalArray<const T> critical() const {
+        return JavaCriticalArray<const T>(array, JavaEnv::get());
+    }
+};
+
+template <typename T>
+struct JavaType<JavaArray<T>> {
+    static constexpr auto symbol = JavaArrayElement<T>::symbol;
+};
+
+template <typename T, std::size_t Extent>
+struct JavaType<std::span<T, Extent>> {
+    static constexpr auto symbol = JavaArrayElement<std::remove_const_t<T>>::symbol;
+    static constexpr bool createsLocalRef = true;
+};
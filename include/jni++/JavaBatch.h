@@ -0,0 +1,145 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaDirectBuffer.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaNative.h>
+#include <jni++/JavaType.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// One argument column of a batched call, handed to Java as a native-order
+// direct buffer over the container's memory (IntBuffer for int32_t, ...).
+template <typename Container, typename = void>
+class JavaBatchColumn {
+    using ValueType = std::remove_cv_t<typename Container::value_type>;
+    static_assert(JavaBufferElement<ValueType>::value, "callBatch: a column holds arithmetic values (other than bool) or std::string");
+
+    const Container& values;
+
+public:
+    static constexpr auto symbol = JavaFixedString{"L"} + JavaBufferView<ValueType>::classPath + JavaFixedString{";"};
+    static constexpr std::size_t arguments = 1;
+
+    explicit JavaBatchColumn(const Container& values) : values(values) {
+    }
+
+    std::size_t size() const {
+        return values.size();
+    }
+
+    jvalue* append(jvalue* out, JNIEnv* env) const {
+        out->l = JavaDirectBufferPool::getInstance().get(values.data(), values.size(), env);
+        return out + 1;
+    }
+};
+
+// A string column is packed into one UTF-8 ByteBuffer plus an IntBuffer of
+// rows + 1 offsets, so row i is bytes [offsets.get(i), offsets.get(i + 1)).
+// The packing buffers are thread-local and reused from one batch to the next;
+// their size changes with every batch, so their views are created per call
+// rather than pooled.
+//
+//     String row(ByteBuffer bytes, IntBuffer offsets, int i) {
+//         var start = offsets.get(i);
+//         return StandardCharsets.UTF_8.decode(bytes.slice(start, offsets.get(i + 1) - start)).toString();
+//     }
+template <typename Container>
+class JavaBatchColumn<Container, std::enable_if_t<std::is_same_v<std::remove_cv_t<typename Container::value_type>, std::string>>> {
+    JavaNativeScratch<std::vector<char>> bytes;
+    JavaNativeScratch<std::vector<int32_t>> offsets;
+
+public:
+    static constexpr JavaFixedString symbol{"Ljava/nio/ByteBuffer;Ljava/nio/IntBuffer;"};
+    static constexpr std::size_t arguments = 2;
+
+    explicit JavaBatchColumn(const Container& values) {
+        auto& data = bytes.get();
+        auto& bounds = offsets.get();
+        data.clear();
+        data.reserve(1);
+        bounds.clear();
+        bounds.push_back(0);
+        for (const auto& value : values) {
+            data.insert(data.end(), value.begin(), value.end());
+            bounds.push_back(static_cast<int32_t>(data.size()));
+        }
+    }
+
+    std::size_t size() const {
+        return offsets.get().size() - 1;
+    }
+
+    jvalue* append(jvalue* out, JNIEnv* env) const {
+        auto& pool = JavaDirectBufferPool::getInstance();
+        out[0].l = pool.create(bytes.get().data(), bytes.get().size(), env);
+        out[1].l = out[0].l == nullptr ? nullptr : pool.create(offsets.get().data(), offsets.get().size(), env);
+        return out + 2;
+    }
+};
+
+// Arguments of a batched call: the row count, the result column and the
+// argument columns, matching a Java bulk method of the form
+//
+//     static void scoreAll(int rows, FloatBuffer results, IntBuffer ids, DoubleBuffer weights)
+//
+// which loops over the rows inside the JVM and writes results with absolute puts.
+template <typename Results, typename... Columns>
+class JavaBatchArguments {
+    using ResultType = typename Results::value_type;
+    static_assert(JavaBufferElement<ResultType>::value, "callBatch: the result column holds arithmetic values other than bool");
+
+    std::tuple<JavaBatchColumn<Columns>...> columns;
+    std::array<jvalue, 2 + (JavaBatchColumn<Columns>::arguments + ... + 0)> values{};
+    JNIEnv* env;
+
+public:
+    static constexpr auto descriptor = JavaFixedString{"(IL"} + JavaBufferView<ResultType>::classPath + JavaFixedString{";"}
+        + (JavaFixedString{""} + ... + JavaBatchColumn<Columns>::symbol) + JavaFixedString{")V"};
+
+    JavaBatchArguments(Results& results, const Columns&... arguments) : columns(arguments...), env(JavaEnv::get()) {
+        auto rows = results.size();
+        std::apply([&](const auto&... column) {
+            if (((column.size() != rows) || ...)) {
+                throw std::invalid_argument("callBatch: every column needs one value per result row");
+            }
+        }, columns);
+        values[0].i = static_cast<jint>(rows);
+        values[1].l = JavaDirectBufferPool::getInstance().get(results.data(), rows, env);
+        auto next = values.data() + 2;
+        std::apply([&](const auto&... column) {
+            ((next = column.append(next, env)), ...);
+        }, columns);
+    }
+
+    JavaBatchArguments(JavaBatchArguments const&) = delete;
+    JavaBatchArguments& operator=(JavaBatchArguments const&) = delete;
+
+    // Every buffer argument is a local reference owned by the arguments.
+    ~JavaBatchArguments() {
+        for (std::size_t i = 1; i < values.size(); ++i) {
+            if (values[i].l != nullptr) {
+                env->DeleteLocalRef(values[i].l);
+            }
+        }
+    }
+
+    // False when a buffer could not be created; the Java exception is then pending.
+    bool valid() const {
+        for (std::size_t i = 1; i < values.size(); ++i) {
+            if (values[i].l == nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    jvalue* data() {
+        return values.data();
+    }
+};
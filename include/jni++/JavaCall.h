@@ -0,0 +1,85 @@
+#pragma once
+#include <jni.h>
+#include <cstdint>
+
+// Binds a C++ return type to the Call<Type>MethodA, CallStatic<Type>MethodA
+// and CallNonvirtual<Type>MethodA functions of its Java type, following the
+// descriptors JavaType gives each C++ type. Types without an entry are
+// object-valued: they are called through the Object variants and their
+// result still has to be converted (converted is true).
+template <typename T, typename Native,
+          Native (JNIEnv::*Call)(jobject, jmethodID, const jvalue*),
+          Native (JNIEnv::*CallStatic)(jclass, jmethodID, const jvalue*),
+          Native (JNIEnv::*CallNonvirtual)(jobject, jclass, jmethodID, const jvalue*)>
+struct JavaCallVariants {
+    using NativeType = Native;
+
+    static constexpr bool converted = false;
+
+    static T call(JNIEnv* env, jobject object, jmethodID methodId, const jvalue* args) {
+        return static_cast<T>((env->*Call)(object, methodId, args));
+    }
+
+    static T callStatic(JNIEnv* env, jclass classId, jmethodID methodId, const jvalue* args) {
+        return static_cast<T>((env->*CallStatic)(classId, methodId, args));
+    }
+
+    static T callNonvirtual(JNIEnv* env, jobject object, jclass classId, jmethodID methodId, const jvalue* args) {
+        return static_cast<T>((env->*CallNonvirtual)(object, classId, methodId, args));
+    }
+};
+
+using JavaObjectCall = JavaCallVariants<jobject, jobject, &JNIEnv::CallObjectMethodA, &JNIEnv::CallStaticObjectMethodA, &JNIEnv::CallNonvirtualObjectMethodA>;
+
+template <typename T>
+struct JavaCallTraits : JavaObjectCall {
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaCallTraits<jobject> : JavaObjectCall {
+};
+
+template <>
+struct JavaCallTraits<void> : JavaCallVariants<void, void, &JNIEnv::CallVoidMethodA, &JNIEnv::CallStaticVoidMethodA, &JNIEnv::CallNonvirtualVoidMethodA> {
+};
+
+template <>
+struct JavaCallTraits<bool> : JavaCallVariants<bool, jboolean, &JNIEnv::CallBooleanMethodA, &JNIEnv::CallStaticBooleanMethodA, &JNIEnv::CallNonvirtualBooleanMethodA> {
+};
+
+template <>
+struct JavaCallTraits<uint8_t> : JavaCallVariants<uint8_t, jshort, &JNIEnv::CallShortMethodA, &JNIEnv::CallStaticShortMethodA, &JNIEnv::CallNonvirtualShortMethodA> {
+};
+
+template <>
+struct JavaCallTraits<int8_t> : JavaCallVariants<int8_t, jchar, &JNIEnv::CallCharMethodA, &JNIEnv::CallStaticCharMethodA, &JNIEnv::CallNonvirtualCharMethodA> {
+};
+
+template <>
+struct JavaCallTraits<int16_t> : JavaCallVariants<int16_t, jshort, &JNIEnv::CallShortMethodA, &JNIEnv::CallStaticShortMethodA, &JNIEnv::CallNonvirtualShortMethodA> {
+};
+
+template <>
+struct JavaCallTraits<uint16_t> : JavaCallVariants<uint16_t, jint, &JNIEnv::CallIntMethodA, &JNIEnv::CallStaticIntMethodA, &JNIEnv::CallNonvirtualIntMethodA> {
+};
+
+template <>
+struct JavaCallTraits<int32_t> : JavaCallVariants<int32_t, jint, &JNIEnv::CallIntMethodA, &JNIEnv::CallStaticIntMethodA, &JNIEnv::CallNonvirtualIntMethodA> {
+};
+
+template <>
+struct JavaCallTraits<uint32_t> : JavaCallVariants<uint32_t, jlong, &JNIEnv::CallLongMethodA, &JNIEnv::CallStaticLongMethodA, &JNIEnv::CallNonvirtualLongMethodA> {
+};
+
+template <>
+struct JavaCallTraits<int64_t> : JavaCallVariants<int64_t, jlong, &JNIEnv::CallLongMethodA, &JNIEnv::CallStaticLongMethodA, &JNIEnv::CallNonvirtualLongMethodA> {
+};
+
+template <>
+struct JavaCallTraits<float> : JavaCallVariants<float, jfloat, &JNIEnv::CallFloatMethodA, &JNIEnv::CallStaticFloatMethodA, &JNIEnv::CallNonvirtualFloatMethodA> {
+};
+
+template <>
+struct JavaCallTraits<double> : JavaCallVariants<double, jdouble, &JNIEnv::CallDoubleMethodA, &JNIEnv::CallStaticDoubleMethodA, &JNIEnv::CallNonvirtualDoubleMethodA> {
+};
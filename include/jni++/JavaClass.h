@@ -1,295 +1,418 @@
 #pragma once
 #include <jni.h>
+#include <jni++/JavaType.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaArguments.h>
+#include <jni++/JavaArray.h>
+#include <jni++/JavaString.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaInstrumentation.h>
+#include <jni++/JavaField.h>
+#include <jni++/JavaBatch.h>
+#include <jni++/JavaNative.h>
+#include <jni++/JavaCall.h>
 #include <string>
 #include <memory>
-#include <iostream>
-#include <sstream>
 #include <map>
 #include <algorithm>
+#include <stdexcept>
+
+class JavaObj;
+
+enum class JavaOwnership;
+
+template <JavaOwnership Ownership>
+class JavaRef;
+
+template <typename Signature>
+class JavaStaticMethod;
+
+template <typename R, typename... Args>
+class JavaBoundMethod;
 
 class JavaClass {
-    std::map<std::string, jmethodID> methodCache;
+    template <typename R, typename... Args>
+    friend class JavaBoundMethod;
 
 protected:
-    std::string classPath;
+    JavaClassEntry* classEntry;
     jclass classId;
-    JNIEnv* env;
-    
+
 public:
     JavaClass() : JavaClass("uninitialized") {
     }
 
-    JavaClass(std::string classpath) : classPath(classpath), classId(nullptr) {
-        std::replace(this->classPath.begin(), this->classPath.end(), '.', '/');
+    JavaClass(std::string classPath) : classEntry(&JavaClassRegistry::getInstance().get(std::move(classPath))), classId(nullptr) {
+    }
+
+    JavaClass(std::string classPath, JNIEnv* jniEnv) : JavaClass(JavaClassRegistry::getInstance().get(std::move(classPath)), jniEnv) {
     }
 
-    JavaClass(std::string classPath, JNIEnv* jniEnv) : JavaClass(classPath) {
-        env = jniEnv;
-        classId = env->FindClass(this->classPath.c_str());
-        checkExceptions("JavaClass::JavaClass FindClass");
+    JavaClass(JavaClassEntry& entry, JNIEnv* jniEnv) : classEntry(&entry) {
+        JavaEnv::bind(jniEnv);
+        classId = entry.registry.resolve(entry, jniEnv);
+        checkExceptions("JavaClass::JavaClass FindClass", jniEnv);
+    }
+
+    const std::string& getClassPath() const {
+        return classEntry->classPath;
+    }
+
+    JavaClassEntry& getClassEntry() const {
+        return *classEntry;
     }
 
     template <typename ReturnType, typename... Args>
-    ReturnType call(std::string name, const ReturnType& returnType, Args&&... args) {
+    ReturnType call(std::string_view name, const ReturnType& returnType, Args&&... args) {
         auto methodId = getStaticMethodID(name, returnType, args...);
-        checkExceptions("JavaClass::call GetStaticMethodId");
+        if (methodId == nullptr) {
+            checkExceptions("JavaClass::call GetStaticMethodID");
+        }
+        JNIPP_CALL_SCOPE(methodId, (localRefsOf<ReturnType, Args...>()));
         auto jvalues = createJValues(args...);
-        auto result = callStaticMethod(methodId, returnType, jvalues.get());
+        auto result = callStaticMethod(methodId, returnType, jvalues.data());
         checkExceptions("JavaClass::call callStaticMethod");
         return result;
     }
 
     template <typename... Args>
-    void callVoid(std::string name, Args&&... args) {
-        callVoid(getStaticVoidMethodID(name, args...));
+    void callVoid(std::string_view name, Args&&... args) {
+        auto methodId = getStaticVoidMethodID(name, args...);
+        if (methodId == nullptr) {
+            checkExceptions("JavaClass::callVoid GetStaticMethodID");
+        }
+        callVoid(methodId, args...);
     }
 
     template <typename... Args>
     void callVoid(jmethodID methodId, Args&&... args) {
-        checkExceptions("JavaClass::callVoid GetStaticMethodId");
+        JNIPP_CALL_SCOPE(methodId, (localRefsOf<void, Args...>()));
         auto jvalues = createJValues(args...);
-        callStaticMethodVoid(methodId, jvalues.get());
-        checkExceptions("JavaClass::call callStaticMethodVoid");
+        callStaticMethodVoid(methodId, jvalues.data());
+        checkExceptions("JavaClass::callVoid callStaticMethodVoid");
     }
 
 
-    template <typename... Args>
-    auto createNew(std::string classPath, Args&&... args) {
-        auto methodId = env->GetMethodID(classId, "<init>", voidSignature(args...).c_str());
-        checkExceptions("JavaClass::createNew GetMethodId");
-        auto jvalues = createJValues(args...);
-        auto objId = env->NewObjectA(classId, methodId, jvalues.get());
-        checkExceptions("JavaClass::createNew NewObjectA");
-        return JavaObj(classPath, objId, classId, env);
+    // Calls a static bulk method once for all rows: results and the argument
+    // columns are passed as direct buffers (see JavaBatchArguments).
+    template <typename Results, typename... Columns>
+    void callBatch(std::string_view name, Results& results, const Columns&... columns) {
+        if (results.size() == 0) {
+            return;
+        }
+        JavaBatchArguments<Results, Columns...> arguments(results, columns...);
+        if (!arguments.valid()) {
+            checkExceptions("JavaClass::callBatch direct buffers");
+        }
+        auto methodId = lookupStaticMethod(name, JavaBatchArguments<Results, Columns...>::descriptor);
+        if (methodId == nullptr) {
+            checkExceptions("JavaClass::callBatch GetStaticMethodID");
+        }
+        JNIPP_CALL_SCOPE(methodId, 0);
+        callStaticMethodVoid(methodId, arguments.data());
+        checkExceptions("JavaClass::callBatch callStaticMethodVoid");
     }
 
+    // Resolves a static method once and returns a callable handle on it (see
+    // JavaMethod.h). Types without a compile-time descriptor are given as
+    // sample values: the return type first, then the arguments.
+    template <typename Signature, typename... Types>
+    JavaStaticMethod<Signature> bind(std::string_view name, const Types&... types);
+
+    // Constructs an instance of this class. classPath is kept for existing
+    // callers: it may be empty, and otherwise must name this class.
     template <typename... Args>
-    std::unique_ptr<jvalue[]> createJValues(const Args&... args) {
-        auto jvalues = std::make_unique<jvalue[]>(sizeof...(Args));
-        fillJValues(jvalues.get(), 0, args...);
-        return jvalues;
-    }
+    JavaObj createNew(std::string classPath, Args&&... args);
 
-    static std::unique_ptr<jvalue[]> createJValues() {
-        return nullptr;
+    template <typename... Args>
+    static JavaArguments<std::decay_t<const Args>...> createJValues(const Args&... args) {
+        return JavaArguments<std::decay_t<const Args>...>({ toJvalue(args)... }, getEnv());
     }
 
     template <typename FuncType, typename...Args>
     void registerNativeVoid(std::string name, FuncType* function, const Args&... args) {
-        auto signature = voidSignature(args...);
-        std::vector<char> signatureZstr(signature.length() + 1);
-        std::copy(signature.begin(), signature.end(), signatureZstr.begin());
-        std::vector<char> nameZstr(name.length() + 1);
-        std::copy(name.begin(), name.end(), nameZstr.begin());
-
         JNINativeMethod method;
-        method.name = nameZstr.data();
-        method.signature = signatureZstr.data();
-        method.fnPtr = static_cast<void*>(function);
-        if (env->RegisterNatives(classId, &method, 1) < 0) {
-            std::cerr << "Cannot register native methods.\n";
-            exit(EXIT_FAILURE);
-        }
+        method.name = const_cast<char*>(name.c_str());
+        method.signature = const_cast<char*>(voidSignature(args...).data());
+        method.fnPtr = reinterpret_cast<void*>(function);
+        registerNativeMethods(&method, 1);
     }
 
-    static void checkExceptions(std::string where, JNIEnv* env) {
-        if (env->ExceptionCheck()) {
-            auto throwable = env->ExceptionOccurred();
-            if (throwable) {
-                env->ExceptionClear();
-                auto exClass(env->GetObjectClass(throwable));
-                auto classClass(env->FindClass("java/lang/Class"));
-
-                auto getNameMethod = env->GetMethodID(classClass, "getName", "()Ljava/lang/String;");
-                auto name = static_cast<jstring>(env->CallObjectMethod(exClass, getNameMethod));
-                auto utfName = env->GetStringUTFChars(name, nullptr);
-
-                auto getMessageMethod(env->GetMethodID(exClass, "getMessage", "()Ljava/lang/String;"));
-                auto message(static_cast<jstring>(env->CallObjectMethod(throwable, getMessageMethod)));
-                auto utfMessage(env->GetStringUTFChars(message, nullptr));
+    // Registers a whole table of JavaNative entries with one RegisterNatives call.
+    template <auto... Functions>
+    void registerNatives(const JavaNative<Functions>&... natives) {
+        JNINativeMethod methods[] = { natives.method()... };
+        registerNativeMethods(methods, sizeof...(Functions));
+    }
 
-                std::cout << "Exception after " << where << "\n";
-                std::cout << "  --> " << utfName << " : " << utfMessage << "\n";
-                env->ReleaseStringUTFChars(message, utfMessage);
-                env->ReleaseStringUTFChars(name, utfName);
-            }
-        }
+    // Throws the pending Java exception, if any, as a JavaException.
+    static void checkExceptions(const char* where, JNIEnv* env) {
+        JavaException::check(where, env);
     }
 
     template <typename ReturnType>
-    ReturnType fromJObject(jobject object, const ReturnType& returnType) const {
-        return ReturnType(returnType.getClassPath(), object, env);
+    static ReturnType fromJObject(jobject object, const ReturnType& returnType) {
+        return ReturnType(returnType.getClassEntry(), object, getEnv());
+    }
+
+    template <typename T>
+    static JavaArray<T> fromJObject(jobject object, const JavaArray<T>&) {
+        return JavaArray<T>(object);
     }
 
     template <typename ReturnType, typename... Args>
-    jmethodID getStaticMethodID(std::string methodName, const ReturnType& returnType, Args&&... args) {
-        try {
-            return methodCache.at(methodName);
-        }
-        catch (std::out_of_range) {
-            auto methodId = env->GetStaticMethodID(classId, methodName.c_str(), signature(returnType, args...).c_str());
-            methodCache[methodName] = methodId;
-            return methodId;
-        }
+    jmethodID getStaticMethodID(std::string_view methodName, const ReturnType& returnType, Args&&... args) {
+        return lookupStaticMethod(methodName, signature(returnType, args...));
     }
 
     template <typename... Args>
-    jmethodID getStaticVoidMethodID(std::string methodName, Args&&... args) {
-        try {
-            return methodCache.at(methodName);
-        }
-        catch (std::out_of_range) {
-            auto methodId = env->GetStaticMethodID(classId, methodName.c_str(), voidSignature(args...).c_str());
-            methodCache[methodName] = methodId;
-            return methodId;
-        }
+    jmethodID getStaticVoidMethodID(std::string_view methodName, Args&&... args) {
+        return lookupStaticMethod(methodName, voidSignature(args...));
     }
-    
 
-protected:
-    void checkExceptions(std::string where) const {
-        checkExceptions(where, env);
+    template <typename FieldType>
+    jfieldID getFieldID(std::string_view fieldName, const FieldType& fieldType) const {
+        return lookupField(fieldName, JavaDescriptor<FieldType>::get(fieldType));
     }
 
-    template <typename Arg, typename... Args>
-    static void signature(std::stringstream& os, const Arg& arg, const Args&... args) {
-        os << getSymbol(arg);
-        signature(os, args...);
+    // Reads the columns' fields from every element of an Object[] or a
+    // java.util.Collection of this class in one pass, and returns the number
+    // of elements. Null elements read as value-initialized cells.
+    template <typename... Containers>
+    std::size_t readFields(jobject elements, const JavaFieldColumn<Containers>&... columns) {
+        static_assert(sizeof...(Containers) > 0, "readFields needs at least one column");
+        auto env = getEnv();
+        jfieldID fieldIds[] = { lookupField(columns.name, JavaTypeOf<typename JavaFieldColumn<Containers>::ValueType>::symbol)... };
+        checkExceptions("JavaClass::readFields GetFieldID");
+        auto array = toObjectArray(elements);
+        auto count = static_cast<std::size_t>(env->GetArrayLength(array));
+        (columns.values.resize(count), ...);
+        for (std::size_t row = 0; row < count; ++row) {
+            auto element = env->GetObjectArrayElement(array, static_cast<jsize>(row));
+            if (element != nullptr) {
+                std::size_t column = 0;
+                (readCell(element, fieldIds[column++], columns.values, row), ...);
+                env->DeleteLocalRef(element);
+            } else {
+                ((columns.values[row] = typename JavaFieldColumn<Containers>::ValueType{}), ...);
+            }
+        }
+        env->DeleteLocalRef(array);
+        checkExceptions("JavaClass::readFields");
+        return count;
     }
 
-    static void signature(std::stringstream& os) {
-        os << ")";
+    // Writes the columns into the fields of every element of an Object[] or a
+    // java.util.Collection of this class in one pass. Null elements are skipped.
+    template <typename... Containers>
+    std::size_t writeFields(jobject elements, const JavaFieldColumn<Containers>&... columns) {
+        static_assert(sizeof...(Containers) > 0, "writeFields needs at least one column");
+        auto env = getEnv();
+        jfieldID fieldIds[] = { lookupField(columns.name, JavaTypeOf<typename JavaFieldColumn<Containers>::ValueType>::symbol)... };
+        checkExceptions("JavaClass::writeFields GetFieldID");
+        auto array = toObjectArray(elements);
+        auto count = static_cast<std::size_t>(env->GetArrayLength(array));
+        if (((columns.values.size() < count) || ...)) {
+            env->DeleteLocalRef(array);
+            throw std::runtime_error("writeFields: a column has fewer values than there are elements");
+        }
+        for (std::size_t row = 0; row < count; ++row) {
+            auto element = env->GetObjectArrayElement(array, static_cast<jsize>(row));
+            if (element != nullptr) {
+                std::size_t column = 0;
+                (writeField(element, fieldIds[column++], static_cast<const typename JavaFieldColumn<Containers>::ValueType&>(columns.values[row])), ...);
+                env->DeleteLocalRef(element);
+            }
+        }
+        env->DeleteLocalRef(array);
+        checkExceptions("JavaClass::writeFields");
+        return count;
     }
 
-    template <typename... Args>
-    static std::string voidSignature(const Args&... args) {
-        std::stringstream os("(", std::ios_base::out | std::ios_base::ate);
-        signature(os, args...);
-        os << getSymbol();
-        return os.str();
+protected:
+    static JNIEnv* getEnv() {
+        return JavaEnv::get();
     }
 
-    template <typename ReturnType, typename... Args>
-    static std::string signature(const ReturnType& returnType, const Args&... args) {
-        std::stringstream os("(", std::ios_base::out | std::ios_base::ate);
-        signature(os, args...);
-        os << getSymbol(returnType);
-        return os.str();
+    void checkExceptions(const char* where) const {
+        checkExceptions(where, getEnv());
     }
 
-    template <typename T>
-    static std::string getSymbol(const T& type);
-
-    static std::string getSymbol() {
-        return "V";
+    template <typename... Args>
+    static std::string_view voidSignature(const Args&... args) {
+        return JavaSignature<void, std::decay_t<const Args>...>::get(nullptr, args...);
     }
 
-    template <typename Type>
-    jvalue toJvalue(Type& obj);
-
-private:
-    template <typename Arg, typename... Args>
-    void fillJValues(jvalue* jvalues, std::size_t index, const Arg& arg, const Args&... args) {
-        jvalues[index] = toJvalue(arg);
-        fillJValues(jvalues, index + 1, args...);
+    template <typename ReturnType, typename... Args>
+    static std::string_view signature(const ReturnType& returnType, const Args&... args) {
+        return JavaSignature<ReturnType, std::decay_t<const Args>...>::get(&returnType, args...);
     }
 
-    static void fillJValues(jvalue* jvalues, std::size_t) {
+    // Local references a call creates: one per converted argument, plus the result if it is an object.
+    template <typename ReturnType, typename... Args>
+    static constexpr std::uint64_t localRefsOf() {
+        return (std::uint64_t(JavaCreatesLocalRef<std::decay_t<const Args>>::value) + ... + 0)
+            + (std::is_arithmetic_v<ReturnType> || std::is_void_v<ReturnType> ? 0 : 1);
     }
 
-
+    // fromJObject for a reference returned by a call; when the result is
+    // converted to a C++ value the reference is no longer needed and is deleted.
     template <typename ReturnType>
-    ReturnType callStaticMethod(jmethodID methodId, const ReturnType& returnType, jvalue* args) const {
-        auto object = env->CallStaticObjectMethodA(classId, methodId, args);
-        checkExceptions("JavaClass::callStaticMethod CallStaticObjectMethodA");
-        return fromJObject(object, returnType);
-    };
-
-    void callStaticMethodVoid(jmethodID methodId, jvalue* args) const {
-        env->CallStaticVoidMethodA(classId, methodId, args);
-        checkExceptions("JavaClass::callStaticMethodVoid CallStaticVoidMethodA");
-    };
+    static ReturnType convertResult(jobject object, const ReturnType& returnType) {
+        auto result = fromJObject(object, returnType);
+        if constexpr (JavaCreatesLocalRef<ReturnType>::value) {
+            getEnv()->DeleteLocalRef(object);
+        }
+        return result;
+    }
 
+    jfieldID lookupField(std::string_view fieldName, std::string_view descriptor) const {
+        return classEntry->fields.get(fieldName, descriptor, [&] {
+            auto fieldId = getEnv()->GetFieldID(classId, std::string(fieldName).c_str(), descriptor.data());
+            if (fieldId != nullptr) {
+                classEntry->registry.recordMember(JavaManifest::Kind::Field, *classEntry, fieldName, descriptor);
+            }
+            return fieldId;
+        });
+    }
 
-};
+    template <typename FieldType>
+    FieldType readField(jobject object, jfieldID fieldId, const FieldType& fieldType) const {
+        if constexpr (JavaPrimitiveField<FieldType>) {
+            return JavaFieldAccess<FieldType>::get(getEnv(), object, fieldId);
+        } else {
+            return convertResult(getEnv()->GetObjectField(object, fieldId), fieldType);
+        }
+    }
 
-template <>
-inline std::string JavaClass::fromJObject(jobject object, const std::string&) const {
-    auto javaString = static_cast<jstring>(object);
-    auto zString = env->GetStringUTFChars(javaString, nullptr);
-    return std::string(zString);
-}
+    template <typename FieldType>
+    void writeField(jobject object, jfieldID fieldId, const FieldType& value) {
+        auto env = getEnv();
+        if constexpr (JavaPrimitiveField<FieldType>) {
+            JavaFieldAccess<FieldType>::set(env, object, fieldId, value);
+        } else {
+            auto reference = toJvalue(value).l;
+            env->SetObjectField(object, fieldId, reference);
+            if constexpr (JavaCreatesLocalRef<FieldType>::value) {
+                env->DeleteLocalRef(reference);
+            }
+        }
+    }
 
+    template <typename Type>
+    static jvalue toJvalue(Type& obj);
 
-template <>
-inline float JavaClass::callStaticMethod(jmethodID methodId, const float&, jvalue* args) const {
-    return env->CallStaticFloatMethodA(classId, methodId, args);
-}
+    template <typename T, std::size_t Extent>
+    static jvalue toJvalue(const std::span<T, Extent>& values) {
+        jvalue j;
+        j.l = JavaArray<std::remove_const_t<T>>::from(values).getObjId();
+        return j;
+    }
 
-template <>
-inline jobject JavaClass::callStaticMethod(jmethodID methodId, const jobject&, jvalue* args) const {
-    return env->CallStaticObjectMethodA(classId, methodId, args);
-}
+    static jvalue toJvalue(const char* v) {
+        jvalue j;
+        j.l = JavaString::fromUtf8(v, getEnv());
+        return j;
+    }
 
+    template <typename T>
+    static jvalue toJvalue(const JavaArray<T>& array) {
+        jvalue j;
+        j.l = array.getObjId();
+        return j;
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const bool&) {
-    return "Z";
-}
+    template <JavaOwnership Ownership>
+    static jvalue toJvalue(const JavaRef<Ownership>& ref) {
+        jvalue j;
+        j.l = ref.get();
+        return j;
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const uint8_t&) {
-    return "S";
-}
+private:
+    void registerNativeMethods(const JNINativeMethod* methods, jint count) {
+        if (getEnv()->RegisterNatives(classId, methods, count) != JNI_OK) {
+            checkExceptions("JavaClass::registerNatives RegisterNatives");
+            throw std::runtime_error("Cannot register native methods of " + getClassPath());
+        }
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const int8_t&) {
-    return "C";
-}
+    // Strings are read into the column's existing std::string so its capacity is reused.
+    template <typename Container>
+    void readCell(jobject element, jfieldID fieldId, Container& values, std::size_t row) const {
+        using ValueType = typename Container::value_type;
+        if constexpr (std::is_same_v<ValueType, std::string>) {
+            auto env = getEnv();
+            auto string = static_cast<jstring>(env->GetObjectField(element, fieldId));
+            JavaString::toUtf8(string, values[row], env);
+            env->DeleteLocalRef(string);
+        } else {
+            values[row] = readField(element, fieldId, ValueType());
+        }
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const int16_t&) {
-    return "S";
-}
+    // A Collection is turned into an array with one toArray() call; an array
+    // is used as it is. Returns a local reference.
+    jobjectArray toObjectArray(jobject elements) const {
+        auto env = getEnv();
+        auto& registry = JavaClassRegistry::getInstance();
+        auto& collection = registry.get("java/util/Collection");
+        auto collectionClass = registry.resolve(collection, env);
+        checkExceptions("JavaClass::toObjectArray FindClass");
+        if (!env->IsInstanceOf(elements, collectionClass)) {
+            return static_cast<jobjectArray>(env->NewLocalRef(elements));
+        }
+        auto toArray = collection.methods.get("toArray", "()[Ljava/lang/Object;", [&] {
+            return env->GetMethodID(collectionClass, "toArray", "()[Ljava/lang/Object;");
+        });
+        checkExceptions("JavaClass::toObjectArray GetMethodID");
+        auto array = static_cast<jobjectArray>(env->CallObjectMethod(elements, toArray));
+        checkExceptions("JavaClass::toObjectArray toArray");
+        return array;
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const int32_t&) {
-    return "I";
-}
+    jmethodID lookupStaticMethod(std::string_view methodName, std::string_view signature) {
+        return classEntry->methods.get(methodName, signature, [&] {
+            auto methodId = getEnv()->GetStaticMethodID(classId, std::string(methodName).c_str(), signature.data());
+            JNIPP_NAME_METHOD(methodId, getClassPath(), methodName, signature);
+            if (methodId != nullptr) {
+                classEntry->registry.recordMember(JavaManifest::Kind::StaticMethod, *classEntry, methodName, signature);
+            }
+            return methodId;
+        });
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const long&) {
-    return "I";
-}
 
-template <>
-inline std::string JavaClass::getSymbol(const uint16_t&) {
-    return "I";
-}
+    // The CallStatic<Type>MethodA variant comes from JavaCallTraits; object
+    // results are converted once the call is known to have succeeded.
+    template <typename ReturnType>
+    ReturnType callStaticMethod(jmethodID methodId, const ReturnType& returnType, const jvalue* args) const {
+        using Call = JavaCallTraits<ReturnType>;
+        auto result = Call::callStatic(getEnv(), classId, methodId, args);
+        if constexpr (Call::converted) {
+            checkExceptions("JavaClass::callStaticMethod CallStaticObjectMethodA");
+            return convertResult(result, returnType);
+        } else {
+            return result;
+        }
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const uint32_t&) {
-    return "J";
-}
+    void callStaticMethodVoid(jmethodID methodId, const jvalue* args) const {
+        JavaCallTraits<void>::callStatic(getEnv(), classId, methodId, args);
+    }
 
-template <>
-inline std::string JavaClass::getSymbol(const int64_t&) {
-    return "J";
-}
 
-template <>
-inline std::string JavaClass::getSymbol(const float&) {
-    return "F";
-}
+};
 
 template <>
-inline std::string JavaClass::getSymbol(const double&) {
-    return "D";
+inline std::string JavaClass::fromJObject(jobject object, const std::string&) {
+    return JavaString::toUtf8(static_cast<jstring>(object), getEnv());
 }
 
 template <>
-inline std::string JavaClass::getSymbol(const std::string&) {
-    return "Ljava/lang/String;";
+inline std::u16string JavaClass::fromJObject(jobject object, const std::u16string&) {
+    return JavaString::toUtf16(static_cast<jstring>(object), getEnv());
 }
 
 
@@ -366,7 +489,35 @@ inline jvalue JavaClass::toJvalue(const double& v) {
 template <>
 inline jvalue JavaClass::toJvalue(const std::string& v) {
     jvalue j;
-    j.l = env->NewStringUTF(v.c_str());
+    j.l = JavaString::fromUtf8(v.c_str(), getEnv());
+    return j;
+}
+
+template <>
+inline jvalue JavaClass::toJvalue(const std::string_view& v) {
+    jvalue j;
+    j.l = JavaString::fromUtf8(v, getEnv());
+    return j;
+}
+
+template <>
+inline jvalue JavaClass::toJvalue(const std::u16string& v) {
+    jvalue j;
+    j.l = JavaString::fromUtf16(v, getEnv());
+    return j;
+}
+
+template <>
+inline jvalue JavaClass::toJvalue(const std::u16string_view& v) {
+    jvalue j;
+    j.l = JavaString::fromUtf16(v, getEnv());
+    return j;
+}
+
+template <>
+inline jvalue JavaClass::toJvalue(const JavaInternedString& v) {
+    jvalue j;
+    j.l = v.get();
     return j;
 }
 
@@ -0,0 +1,153 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaObj.h>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A java.net.URLClassLoader over one classpath, with its own class registry
+// and so its own class, method and field ID caches. Its parent is the
+// platform class loader: classes of the JVM's own classpath and of other
+// loaders are not visible, so plugins with clashing classes load side by side.
+//
+//     JavaClassLoader plugin("plugins/a.jar:plugins/lib");
+//     auto entry = plugin.getClass("com.example.Plugin");
+//     JavaObj result = entry.call("create", plugin.getType("com.example.Result"));
+//
+// Handles taken from a loader must not outlive it.
+class JavaClassLoader {
+    std::string classPath;
+    jobject loader;
+    JavaClassRegistry registry;
+
+public:
+    explicit JavaClassLoader(std::string classPath, JNIEnv* env = JavaEnv::get())
+        : classPath(std::move(classPath)), loader(create(this->classPath, env)), registry(loader) {
+    }
+
+    JavaClassLoader(JavaClassLoader const&) = delete;
+    JavaClassLoader& operator=(JavaClassLoader const&) = delete;
+
+    ~JavaClassLoader() {
+        if (auto env = JavaEnv::attached()) {
+            registry.clear(env);
+            env->DeleteGlobalRef(loader);
+        }
+    }
+
+    const std::string& getClassPath() const {
+        return classPath;
+    }
+
+    jobject getLoader() const {
+        return loader;
+    }
+
+    JavaClassRegistry& getRegistry() {
+        return registry;
+    }
+
+    JavaClass getClass(std::string classPath) {
+        return JavaClass(registry.get(std::move(classPath)), JavaEnv::get());
+    }
+
+    // An unbound JavaObj of a class of this loader, to pass as a return or field type.
+    JavaObj getType(std::string classPath) {
+        return JavaObj(registry.get(std::move(classPath)), nullptr, JavaEnv::get());
+    }
+
+private:
+    // Entries are separated like the JVM's own -Djava.class.path.
+    static std::vector<std::string> splitClassPath(std::string_view classPath) {
+#ifdef _WIN32
+        constexpr char separator = ';';
+#else
+        constexpr char separator = ':';
+#endif
+        std::vector<std::string> entries;
+        while (!classPath.empty()) {
+            auto end = classPath.find(separator);
+            auto entry = classPath.substr(0, end);
+            if (!entry.empty()) {
+                entries.emplace_back(entry);
+            }
+            classPath = end == std::string_view::npos ? std::string_view() : classPath.substr(end + 1);
+        }
+        return entries;
+    }
+
+    // new URLClassLoader(new URL[] { new File(entry).toURI().toURL(), ... }, ClassLoader.getPlatformClassLoader())
+    static jobject create(const std::string& classPath, JNIEnv* env) {
+        auto& system = JavaClassRegistry::getInstance();
+        auto& fileEntry = system.get("java/io/File");
+        auto& uriEntry = system.get("java/net/URI");
+        auto& urlEntry = system.get("java/net/URL");
+        auto& classLoaderEntry = system.get("java/lang/ClassLoader");
+        auto& urlClassLoaderEntry = system.get("java/net/URLClassLoader");
+        auto fileClass = system.resolve(fileEntry, env);
+        auto uriClass = system.resolve(uriEntry, env);
+        auto urlClass = system.resolve(urlEntry, env);
+        auto classLoaderClass = system.resolve(classLoaderEntry, env);
+        auto urlClassLoaderClass = system.resolve(urlClassLoaderEntry, env);
+        JavaException::check("JavaClassLoader FindClass", env);
+
+        auto fileInit = fileEntry.methods.get("<init>", "(Ljava/lang/String;)V", [&] {
+            return env->GetMethodID(fileClass, "<init>", "(Ljava/lang/String;)V");
+        });
+        auto toUri = fileEntry.methods.get("toURI", "()Ljava/net/URI;", [&] {
+            return env->GetMethodID(fileClass, "toURI", "()Ljava/net/URI;");
+        });
+        auto toUrl = uriEntry.methods.get("toURL", "()Ljava/net/URL;", [&] {
+            return env->GetMethodID(uriClass, "toURL", "()Ljava/net/URL;");
+        });
+        auto platformLoader = classLoaderEntry.methods.get("getPlatformClassLoader", "()Ljava/lang/ClassLoader;", [&] {
+            return env->GetStaticMethodID(classLoaderClass, "getPlatformClassLoader", "()Ljava/lang/ClassLoader;");
+        });
+        auto loaderInit = urlClassLoaderEntry.methods.get("<init>", "([Ljava/net/URL;Ljava/lang/ClassLoader;)V", [&] {
+            return env->GetMethodID(urlClassLoaderClass, "<init>", "([Ljava/net/URL;Ljava/lang/ClassLoader;)V");
+        });
+        JavaException::check("JavaClassLoader GetMethodID", env);
+
+        auto entries = splitClassPath(classPath);
+        auto urls = env->NewObjectArray(static_cast<jsize>(entries.size()), urlClass, nullptr);
+        JavaException::check("JavaClassLoader NewObjectArray", env);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            auto path = env->NewStringUTF(entries[i].c_str());
+            auto file = path == nullptr ? nullptr : env->NewObject(fileClass, fileInit, path);
+            auto uri = file == nullptr ? nullptr : env->CallObjectMethod(file, toUri);
+            auto url = uri == nullptr ? nullptr : env->CallObjectMethod(uri, toUrl);
+            if (url != nullptr) {
+                env->SetObjectArrayElement(urls, static_cast<jsize>(i), url);
+            }
+            for (auto reference : { jobject(path), file, uri, url }) {
+                if (reference != nullptr) {
+                    env->DeleteLocalRef(reference);
+                }
+            }
+            if (env->ExceptionCheck()) {
+                env->DeleteLocalRef(urls);
+                JavaException::check("JavaClassLoader URL", env);
+            }
+        }
+
+        auto parent = env->CallStaticObjectMethod(classLoaderClass, platformLoader);
+        auto localLoader = parent == nullptr ? nullptr : env->NewObject(urlClassLoaderClass, loaderInit, urls, parent);
+        env->DeleteLocalRef(urls);
+        if (parent != nullptr) {
+            env->DeleteLocalRef(parent);
+        }
+        if (localLoader == nullptr) {
+            JavaException::check("JavaClassLoader URLClassLoader", env);
+            throw std::runtime_error("Cannot create a class loader for " + classPath);
+        }
+        auto globalLoader = env->NewGlobalRef(localLoader);
+        env->DeleteLocalRef(localLoader);
+        return globalLoader;
+    }
+};
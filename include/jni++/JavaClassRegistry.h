@@ -0,0 +1,188 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaInstrumentation.h>
+#include <jni++/JavaManifest.h>
+#include <jni++/JavaMethodCache.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class JavaClassRegistry;
+
+// Metadata shared by every JavaClass/JavaObj handle of one class: the
+// registry it belongs to, the slash-separated class path, a global reference
+// to the jclass once it has been resolved, and the method and field IDs
+// resolved so far.
+struct JavaClassEntry {
+    JavaClassEntry(JavaClassRegistry& registry, std::string classPath) : registry(registry), classPath(std::move(classPath)) {
+    }
+
+    JavaClassEntry(const JavaClassEntry&) = delete;
+    JavaClassEntry& operator=(const JavaClassEntry&) = delete;
+
+    JavaClassRegistry& registry;
+    const std::string classPath;
+    std::atomic<jclass> classId{nullptr};
+    JavaMethodCache methods;
+    JavaFieldCache fields;
+};
+
+// Intern table of classes. Each class path maps to one entry for the lifetime
+// of the registry, so handles can keep a plain pointer to it, and the class is
+// looked up once rather than once per returned object.
+//
+// getInstance() is the process-wide table of the system class loader, where
+// classes are found with FindClass. A registry given a class loader (see
+// JavaClassLoader) finds them with Class.forName through that loader instead,
+// and keeps its own method and field IDs.
+class JavaClassRegistry {
+    std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<JavaClassEntry>> entries;
+    jobject loader;
+    std::atomic<JavaManifest*> manifest{nullptr};
+
+public:
+    static JavaClassRegistry& getInstance() {
+        static JavaClassRegistry instance;
+        return instance;
+    }
+
+    // loader is a global reference, kept by the caller for the registry's lifetime.
+    explicit JavaClassRegistry(jobject loader) : loader(loader) {
+    }
+
+    JavaClassRegistry(JavaClassRegistry const&) = delete;
+    JavaClassRegistry(JavaClassRegistry&&) = delete;
+
+    // Accepts dotted or slash-separated paths; does not touch the JVM.
+    JavaClassEntry& get(std::string classPath) {
+        std::replace(classPath.begin(), classPath.end(), '.', '/');
+        std::lock_guard<std::mutex> lock(mutex);
+        auto& entry = entries[classPath];
+        if (!entry) {
+            entry = std::make_unique<JavaClassEntry>(*this, classPath);
+        }
+        return *entry;
+    }
+
+    // Returns the global class reference, looking the class up on first use.
+    // On failure returns nullptr and leaves the Java exception pending.
+    jclass resolve(JavaClassEntry& entry, JNIEnv* env) {
+        if (auto classId = entry.classId.load(std::memory_order_acquire)) {
+            return classId;
+        }
+        // No lock is held while looking the class up: FindClass and forName
+        // can run a static initializer that re-enters the registry. A thread
+        // that loses the race to publish drops its duplicate reference.
+        JNIPP_RECORD_FIND_CLASS();
+        auto localClass = loader == nullptr ? env->FindClass(entry.classPath.c_str()) : loadClass(entry.classPath, env);
+        if (localClass == nullptr) {
+            return nullptr;
+        }
+        auto classId = static_cast<jclass>(env->NewGlobalRef(localClass));
+        env->DeleteLocalRef(localClass);
+        jclass published = nullptr;
+        if (!entry.classId.compare_exchange_strong(published, classId, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            env->DeleteGlobalRef(classId);
+            return published;
+        }
+        if (auto recorder = manifest.load(std::memory_order_acquire)) {
+            recorder->add(JavaManifest::Kind::Class, entry.classPath);
+        }
+        return classId;
+    }
+
+    // Records every class and member resolved from now on into manifest, or
+    // stops recording when it is nullptr. The manifest must outlive the recording.
+    void record(JavaManifest* recorder) {
+        manifest.store(recorder, std::memory_order_release);
+    }
+
+    // Called by the lookups once they have resolved a member of entry.
+    void recordMember(JavaManifest::Kind kind, const JavaClassEntry& entry, std::string_view name, std::string_view signature) {
+        if (auto recorder = manifest.load(std::memory_order_acquire)) {
+            recorder->add(kind, entry.classPath, name, signature);
+        }
+    }
+
+    // Resolves every class and member of the manifest into this registry and
+    // returns how many were found. Entries that no longer resolve are skipped.
+    std::size_t prewarm(const JavaManifest& replay, JNIEnv* env) {
+        std::size_t resolved = 0;
+        for (auto& item : replay.getEntries()) {
+            auto& entry = get(item.classPath);
+            auto classId = resolve(entry, env);
+            bool found = classId != nullptr;
+            if (found && item.kind == JavaManifest::Kind::Field) {
+                found = entry.fields.get(item.name, item.signature, [&] {
+                    return env->GetFieldID(classId, item.name.c_str(), item.signature.c_str());
+                }) != nullptr;
+            } else if (found && item.kind != JavaManifest::Kind::Class) {
+                found = entry.methods.get(item.name, item.signature, [&] {
+                    auto methodId = item.kind == JavaManifest::Kind::StaticMethod
+                        ? env->GetStaticMethodID(classId, item.name.c_str(), item.signature.c_str())
+                        : env->GetMethodID(classId, item.name.c_str(), item.signature.c_str());
+                    JNIPP_NAME_METHOD(methodId, item.classPath, item.name, item.signature);
+                    return methodId;
+                }) != nullptr;
+            }
+            if (found) {
+                if (item.kind != JavaManifest::Kind::Class) {
+                    recordMember(item.kind, entry, item.name, item.signature);
+                }
+                ++resolved;
+            } else {
+                env->ExceptionClear();
+            }
+        }
+        return resolved;
+    }
+
+    // Drops every global reference, method and field ID; must run before the JVM is destroyed.
+    void clear(JNIEnv* env) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [classPath, entry] : entries) {
+            if (auto classId = entry->classId.exchange(nullptr)) {
+                env->DeleteGlobalRef(classId);
+            }
+            entry->methods.clear();
+            entry->fields.clear();
+        }
+    }
+
+    jobject getLoader() const {
+        return loader;
+    }
+
+private:
+    JavaClassRegistry() : loader(nullptr) {
+    }
+
+    jclass loadClass(std::string classPath, JNIEnv* env) {
+        auto& system = getInstance();
+        auto& classClass = system.get("java/lang/Class");
+        auto classClassId = system.resolve(classClass, env);
+        if (classClassId == nullptr) {
+            return nullptr;
+        }
+        auto forName = classClass.methods.get("forName", "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;", [&] {
+            return env->GetStaticMethodID(classClassId, "forName", "(Ljava/lang/String;ZLjava/lang/ClassLoader;)Ljava/lang/Class;");
+        });
+        if (forName == nullptr) {
+            return nullptr;
+        }
+        std::replace(classPath.begin(), classPath.end(), '/', '.');
+        auto name = env->NewStringUTF(classPath.c_str());
+        if (name == nullptr) {
+            return nullptr;
+        }
+        auto classId = static_cast<jclass>(env->CallStaticObjectMethod(classClassId, forName, name, JNI_FALSE, loader));
+        env->DeleteLocalRef(name);
+        return env->ExceptionCheck() ? nullptr : classId;
+    }
+};
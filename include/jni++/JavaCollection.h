@@ -0,0 +1,487 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClass.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaObj.h>
+#include <jni++/JavaRef.h>
+#include <jni++/JavaType.h>
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// How a boxed element is unboxed into a C++ arithmetic type.
+template <typename T>
+struct JavaUnboxed;
+
+template <>
+struct JavaUnboxed<bool> {
+    static constexpr const char* classPath = "java/lang/Boolean";
+    static constexpr const char* name = "booleanValue";
+    static constexpr const char* signature = "()Z";
+    static constexpr auto call = &JNIEnv::CallBooleanMethodA;
+};
+
+template <>
+struct JavaUnboxed<char16_t> {
+    static constexpr const char* classPath = "java/lang/Character";
+    static constexpr const char* name = "charValue";
+    static constexpr const char* signature = "()C";
+    static constexpr auto call = &JNIEnv::CallCharMethodA;
+};
+
+template <>
+struct JavaUnboxed<int8_t> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "byteValue";
+    static constexpr const char* signature = "()B";
+    static constexpr auto call = &JNIEnv::CallByteMethodA;
+};
+
+template <>
+struct JavaUnboxed<int16_t> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "shortValue";
+    static constexpr const char* signature = "()S";
+    static constexpr auto call = &JNIEnv::CallShortMethodA;
+};
+
+template <>
+struct JavaUnboxed<int32_t> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "intValue";
+    static constexpr const char* signature = "()I";
+    static constexpr auto call = &JNIEnv::CallIntMethodA;
+};
+
+template <>
+struct JavaUnboxed<int64_t> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "longValue";
+    static constexpr const char* signature = "()J";
+    static constexpr auto call = &JNIEnv::CallLongMethodA;
+};
+
+template <>
+struct JavaUnboxed<float> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "floatValue";
+    static constexpr const char* signature = "()F";
+    static constexpr auto call = &JNIEnv::CallFloatMethodA;
+};
+
+template <>
+struct JavaUnboxed<double> {
+    static constexpr const char* classPath = "java/lang/Number";
+    static constexpr const char* name = "doubleValue";
+    static constexpr const char* signature = "()D";
+    static constexpr auto call = &JNIEnv::CallDoubleMethodA;
+};
+
+// Walks a java.lang.Iterable or java.util.Iterator a chunk at a time. Each
+// chunk's element references are fetched into a fresh local frame, popped
+// when the next chunk is fetched or the walk ends:
+// - a RandomAccess List with one subList(from, to).toArray() per chunk,
+// - any other Collection with one toArray() for the whole walk,
+// - anything else with hasNext()/next() per element, Java having no bulk
+//   form of Iterator.
+class JavaChunkCursor {
+    enum class Source {
+        List,
+        Array,
+        Iterator
+    };
+
+    JNIEnv* env;
+    jobject iterable;
+    jint chunkSize;
+    jint frameCapacity;
+    Source source = Source::Iterator;
+    // The Object[] of a Collection or the Iterator, in the caller's frame.
+    jobject walked = nullptr;
+    jint length = 0;
+    jint position = 0;
+    bool frameOpen = false;
+    std::vector<jobject> chunk;
+    std::size_t index = 0;
+
+public:
+    static constexpr std::size_t defaultChunkSize = 256;
+
+    JavaChunkCursor(jobject iterable, std::size_t chunkSize, jint refsPerElement, JNIEnv* env)
+        : env(env), iterable(iterable), chunkSize(static_cast<jint>(std::clamp<std::size_t>(chunkSize, 1, INT_MAX / 4))) {
+        frameCapacity = this->chunkSize * refsPerElement + 4;
+        if (iterable == nullptr) {
+            return;
+        }
+        // The destructor does not run if this throws, so undo the walk here.
+        try {
+            if (env->IsInstanceOf(iterable, classOf("java/util/List")) && env->IsInstanceOf(iterable, classOf("java/util/RandomAccess"))) {
+                source = Source::List;
+                length = env->CallIntMethodA(iterable, methodOf("java/util/Collection", "size", "()I"), nullptr);
+            } else if (env->IsInstanceOf(iterable, classOf("java/util/Collection"))) {
+                source = Source::Array;
+                walked = env->CallObjectMethodA(iterable, methodOf("java/util/Collection", "toArray", "()[Ljava/lang/Object;"), nullptr);
+                JavaException::check("JavaChunkCursor Collection.toArray", env);
+                length = env->GetArrayLength(static_cast<jobjectArray>(walked));
+            } else if (env->IsInstanceOf(iterable, classOf("java/util/Iterator"))) {
+                walked = env->NewLocalRef(iterable);
+            } else {
+                walked = env->CallObjectMethodA(iterable, methodOf("java/lang/Iterable", "iterator", "()Ljava/util/Iterator;"), nullptr);
+            }
+            JavaException::check("JavaChunkCursor", env);
+            chunk.reserve(static_cast<std::size_t>(this->chunkSize));
+            fetch();
+        } catch (...) {
+            closeFrame();
+            if (walked != nullptr) {
+                env->DeleteLocalRef(walked);
+            }
+            throw;
+        }
+    }
+
+    JavaChunkCursor(JavaChunkCursor const&) = delete;
+    JavaChunkCursor& operator=(JavaChunkCursor const&) = delete;
+
+    ~JavaChunkCursor() {
+        closeFrame();
+        if (walked != nullptr) {
+            env->DeleteLocalRef(walked);
+        }
+    }
+
+    bool done() const {
+        return index >= chunk.size();
+    }
+
+    jobject current() const {
+        return chunk[index];
+    }
+
+    void next() {
+        if (++index >= chunk.size()) {
+            fetch();
+        }
+    }
+
+    JNIEnv* getEnv() const {
+        return env;
+    }
+
+    // A method ID of a JDK class, cached in the system registry.
+    static jmethodID lookupMethod(const char* classPath, const char* name, const char* signature, JNIEnv* env) {
+        auto& registry = JavaClassRegistry::getInstance();
+        auto& entry = registry.get(classPath);
+        auto classId = registry.resolve(entry, env);
+        JavaException::check("JavaChunkCursor FindClass", env);
+        auto methodId = entry.methods.get(name, signature, [&] {
+            return env->GetMethodID(classId, name, signature);
+        });
+        JavaException::check("JavaChunkCursor GetMethodID", env);
+        return methodId;
+    }
+
+private:
+    void fetch() {
+        closeFrame();
+        chunk.clear();
+        index = 0;
+        if (iterable == nullptr || (source != Source::Iterator && position >= length)) {
+            return;
+        }
+        if (env->PushLocalFrame(frameCapacity) != JNI_OK) {
+            env->ExceptionClear();
+            throw std::runtime_error("PushLocalFrame failed");
+        }
+        frameOpen = true;
+        switch (source) {
+        case Source::List: {
+            auto end = std::min(length, position + chunkSize);
+            jvalue range[2];
+            range[0].i = position;
+            range[1].i = end;
+            auto subList = env->CallObjectMethodA(iterable, methodOf("java/util/List", "subList", "(II)Ljava/util/List;"), range);
+            JavaException::check("JavaChunkCursor List.subList", env);
+            auto array = env->CallObjectMethodA(subList, methodOf("java/util/Collection", "toArray", "()[Ljava/lang/Object;"), nullptr);
+            JavaException::check("JavaChunkCursor List.toArray", env);
+            collect(static_cast<jobjectArray>(array), 0, std::min(end - position, env->GetArrayLength(static_cast<jobjectArray>(array))));
+            position = end;
+            break;
+        }
+        case Source::Array: {
+            auto count = std::min(chunkSize, length - position);
+            collect(static_cast<jobjectArray>(walked), position, count);
+            position += count;
+            break;
+        }
+        case Source::Iterator: {
+            auto hasNext = methodOf("java/util/Iterator", "hasNext", "()Z");
+            auto nextElement = methodOf("java/util/Iterator", "next", "()Ljava/lang/Object;");
+            while (static_cast<jint>(chunk.size()) < chunkSize && env->CallBooleanMethodA(walked, hasNext, nullptr)) {
+                chunk.push_back(env->CallObjectMethodA(walked, nextElement, nullptr));
+                JavaException::check("JavaChunkCursor Iterator.next", env);
+            }
+            JavaException::check("JavaChunkCursor Iterator.hasNext", env);
+            break;
+        }
+        }
+        if (chunk.empty()) {
+            closeFrame();
+        }
+    }
+
+    void collect(jobjectArray array, jint from, jint count) {
+        for (jint i = 0; i < count; ++i) {
+            chunk.push_back(env->GetObjectArrayElement(array, from + i));
+        }
+    }
+
+    void closeFrame() {
+        if (frameOpen) {
+            frameOpen = false;
+            env->PopLocalFrame(nullptr);
+        }
+    }
+
+    jclass classOf(const char* classPath) const {
+        auto& registry = JavaClassRegistry::getInstance();
+        auto classId = registry.resolve(registry.get(classPath), env);
+        JavaException::check("JavaChunkCursor FindClass", env);
+        return classId;
+    }
+
+    jmethodID methodOf(const char* classPath, const char* name, const char* signature) const {
+        return lookupMethod(classPath, name, signature, env);
+    }
+};
+
+// Converts an element reference to T: arithmetic types unbox the element,
+// every other type converts as a call result of that type would.
+template <typename T>
+class JavaElement {
+    T type;
+    jmethodID unbox = nullptr;
+
+public:
+    static constexpr jint localRefsPerElement = 1;
+
+    explicit JavaElement(T type) : type(std::move(type)) {
+    }
+
+    void prepare(JNIEnv* env) {
+        if constexpr (std::is_arithmetic_v<T>) {
+            unbox = JavaChunkCursor::lookupMethod(JavaUnboxed<T>::classPath, JavaUnboxed<T>::name, JavaUnboxed<T>::signature, env);
+        }
+    }
+
+    T operator()(jobject element, JNIEnv* env) const {
+        if constexpr (std::is_arithmetic_v<T>) {
+            if (element == nullptr) {
+                throw std::runtime_error("JavaElement: a null element cannot be unboxed");
+            }
+            auto value = (env->*JavaUnboxed<T>::call)(element, unbox, nullptr);
+            JavaException::check("JavaElement unbox", env);
+            if constexpr (std::is_same_v<T, bool>) {
+                return value != JNI_FALSE;
+            } else {
+                return static_cast<T>(value);
+            }
+        } else {
+            return JavaClass::fromJObject(element, type);
+        }
+    }
+};
+
+// Converts a java.util.Map.Entry reference to a (key, value) pair.
+template <typename K, typename V>
+class JavaMapEntry {
+    JavaElement<K> key;
+    JavaElement<V> value;
+    jmethodID getKey = nullptr;
+    jmethodID getValue = nullptr;
+
+public:
+    static constexpr jint localRefsPerElement = 3;
+
+    JavaMapEntry(K keyType, V valueType) : key(std::move(keyType)), value(std::move(valueType)) {
+    }
+
+    void prepare(JNIEnv* env) {
+        key.prepare(env);
+        value.prepare(env);
+        getKey = JavaChunkCursor::lookupMethod("java/util/Map$Entry", "getKey", "()Ljava/lang/Object;", env);
+        getValue = JavaChunkCursor::lookupMethod("java/util/Map$Entry", "getValue", "()Ljava/lang/Object;", env);
+    }
+
+    std::pair<K, V> operator()(jobject entry, JNIEnv* env) const {
+        return std::pair<K, V>(part(key, entry, getKey, env), part(value, entry, getValue, env));
+    }
+
+private:
+    template <typename T>
+    static T part(const JavaElement<T>& element, jobject entry, jmethodID getter, JNIEnv* env) {
+        auto object = env->CallObjectMethodA(entry, getter, nullptr);
+        JavaException::check("JavaMapEntry getKey/getValue", env);
+        T result = element(object, env);
+        if constexpr (std::is_arithmetic_v<T> || JavaCreatesLocalRef<T>::value) {
+            env->DeleteLocalRef(object);
+        }
+        return result;
+    }
+};
+
+// A single-pass C++20 input range over a Java Iterable, fetched through a
+// JavaChunkCursor. Elements are converted once, when first dereferenced.
+// JavaObj and JavaLocalRef elements, and every local reference created in the
+// loop body, live in the chunk's local frame: keep an element past its chunk
+// as a JavaGlobalRef. Walks of several ranges must nest, as local frames do.
+template <typename Value, typename Converter>
+class JavaRange {
+    struct State {
+        JavaChunkCursor cursor;
+        std::optional<Value> value;
+
+        State(jobject iterable, std::size_t chunkSize, JNIEnv* env)
+            : cursor(iterable, chunkSize, Converter::localRefsPerElement, env) {
+        }
+    };
+
+    JavaLocalRef source;
+    Converter converter;
+    std::size_t chunkSize;
+    std::unique_ptr<State> state;
+
+public:
+    class iterator {
+        JavaRange* range = nullptr;
+
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(JavaRange* range) : range(range) {
+        }
+
+        Value& operator*() const {
+            return range->current();
+        }
+
+        Value* operator->() const {
+            return &range->current();
+        }
+
+        iterator& operator++() {
+            range->advance();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool done() const {
+            return range->state->cursor.done();
+        }
+
+        friend bool operator==(const iterator& it, std::default_sentinel_t) {
+            return it.done();
+        }
+    };
+
+    JavaRange(JavaLocalRef source, Converter converter, std::size_t chunkSize)
+        : source(std::move(source)), converter(std::move(converter)), chunkSize(chunkSize) {
+    }
+
+    // Starts a new walk over the collection.
+    iterator begin() {
+        state.reset();
+        auto env = JavaEnv::get();
+        converter.prepare(env);
+        state = std::make_unique<State>(source.get(), chunkSize, env);
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+
+protected:
+    jobject getSource() const {
+        return source.get();
+    }
+
+private:
+    Value& current() {
+        if (!state->value) {
+            state->value.emplace(converter(state->cursor.current(), state->cursor.getEnv()));
+        }
+        return *state->value;
+    }
+
+    void advance() {
+        state->value.reset();
+        state->cursor.next();
+    }
+};
+
+// A java.lang.Iterable, Collection or Iterator as a range of T:
+//
+//     for (auto& name : JavaIterable<std::string>(names)) { ... }
+//     for (auto& row : JavaIterable<JavaGlobalRef>(rows, JavaGlobalRef(rowType), 1024)) { ... }
+template <typename T>
+class JavaIterable : public JavaRange<T, JavaElement<T>> {
+public:
+    explicit JavaIterable(const JavaObj& iterable, T elementType = T(), std::size_t chunkSize = JavaChunkCursor::defaultChunkSize)
+        : JavaRange<T, JavaElement<T>>(JavaLocalRef(iterable), JavaElement<T>(std::move(elementType)), chunkSize) {
+    }
+};
+
+// A java.util.List as a range of T, with its size.
+template <typename T>
+class JavaList : public JavaIterable<T> {
+public:
+    using JavaIterable<T>::JavaIterable;
+
+    std::size_t size() const {
+        auto env = JavaEnv::get();
+        auto count = env->CallIntMethodA(this->getSource(), JavaChunkCursor::lookupMethod("java/util/Collection", "size", "()I", env), nullptr);
+        JavaException::check("JavaList Collection.size", env);
+        return static_cast<std::size_t>(count);
+    }
+};
+
+// A java.util.Map as a range of (key, value) pairs, walked through its entrySet():
+//
+//     for (auto& [word, count] : JavaMap<std::string, int64_t>(counts)) { ... }
+template <typename K, typename V>
+class JavaMap : public JavaRange<std::pair<K, V>, JavaMapEntry<K, V>> {
+public:
+    explicit JavaMap(const JavaObj& map, K keyType = K(), V valueType = V(), std::size_t chunkSize = JavaChunkCursor::defaultChunkSize)
+        : JavaRange<std::pair<K, V>, JavaMapEntry<K, V>>(entrySet(map), JavaMapEntry<K, V>(std::move(keyType), std::move(valueType)), chunkSize) {
+    }
+
+private:
+    static JavaLocalRef entrySet(const JavaObj& map) {
+        auto env = JavaEnv::get();
+        auto& registry = JavaClassRegistry::getInstance();
+        if (map.getObjId() == nullptr) {
+            return JavaLocalRef(registry.get("java/util/Set"));
+        }
+        auto entries = env->CallObjectMethodA(map.getObjId(), JavaChunkCursor::lookupMethod("java/util/Map", "entrySet", "()Ljava/util/Set;", env), nullptr);
+        JavaException::check("JavaMap Map.entrySet", env);
+        return JavaLocalRef(registry.get("java/util/Set"), entries, env);
+    }
+};
@@ -0,0 +1,264 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaType.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <unordered_map>
+
+// The java.nio buffer type used to expose native memory of element type T.
+// Types without a dedicated view are exposed as a plain ByteBuffer.
+template <typename T>
+struct JavaBufferView {
+    static constexpr JavaFixedString classPath{"java/nio/ByteBuffer"};
+    static constexpr bool converted = false;
+};
+
+template <>
+struct JavaBufferView<char16_t> {
+    static constexpr JavaFixedString classPath{"java/nio/CharBuffer"};
+    static constexpr JavaFixedString asMethod{"asCharBuffer"};
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaBufferView<int16_t> {
+    static constexpr JavaFixedString classPath{"java/nio/ShortBuffer"};
+    static constexpr JavaFixedString asMethod{"asShortBuffer"};
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaBufferView<uint16_t> : JavaBufferView<int16_t> {
+};
+
+template <>
+struct JavaBufferView<int32_t> {
+    static constexpr JavaFixedString classPath{"java/nio/IntBuffer"};
+    static constexpr JavaFixedString asMethod{"asIntBuffer"};
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaBufferView<uint32_t> : JavaBufferView<int32_t> {
+};
+
+template <>
+struct JavaBufferView<int64_t> {
+    static constexpr JavaFixedString classPath{"java/nio/LongBuffer"};
+    static constexpr JavaFixedString asMethod{"asLongBuffer"};
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaBufferView<uint64_t> : JavaBufferView<int64_t> {
+};
+
+template <>
+struct JavaBufferView<float> {
+    static constexpr JavaFixedString classPath{"java/nio/FloatBuffer"};
+    static constexpr JavaFixedString asMethod{"asFloatBuffer"};
+    static constexpr bool converted = true;
+};
+
+template <>
+struct JavaBufferView<double> {
+    static constexpr JavaFixedString classPath{"java/nio/DoubleBuffer"};
+    static constexpr JavaFixedString asMethod{"asDoubleBuffer"};
+    static constexpr bool converted = true;
+};
+
+// Element types a batch column or result can hold: arithmetic values, each
+// read by Java from its buffer view. bool has no fixed representation.
+template <typename T>
+struct JavaBufferElement : std::bool_constant<std::is_arithmetic_v<T> && !std::is_same_v<T, bool>> {};
+
+// Native-order direct buffer views over C++ memory, pooled by (address,
+// length, view type). Linking the same memory again hands back the buffer
+// created the first time instead of building a new one, and the ByteOrder
+// and as*Buffer lookups are done once per process.
+//
+// Pooled views are shared: Java code should use absolute get/put, or
+// duplicate() a view before moving its position.
+class JavaDirectBufferPool {
+    struct Key {
+        const void* address;
+        std::size_t bytes;
+        const void* view;
+
+        bool operator==(const Key& other) const {
+            return address == other.address && bytes == other.bytes && view == other.view;
+        }
+    };
+
+    struct KeyHash {
+        std::size_t operator()(const Key& key) const {
+            auto hash = std::hash<const void*>()(key.address);
+            hash = hash * 31 + std::hash<std::size_t>()(key.bytes);
+            return hash * 31 + std::hash<const void*>()(key.view);
+        }
+    };
+
+    std::mutex mutex;
+    std::unordered_map<Key, jobject, KeyHash> views;
+    std::deque<Key> insertionOrder;
+    std::size_t capacity = 1024;
+    jobject nativeOrder = nullptr;
+
+public:
+    static JavaDirectBufferPool& getInstance() {
+        static JavaDirectBufferPool instance;
+        return instance;
+    }
+
+    JavaDirectBufferPool(JavaDirectBufferPool const&) = delete;
+    JavaDirectBufferPool(JavaDirectBufferPool&&) = delete;
+
+    // Returns a new local reference to the pooled view, owned by the caller,
+    // or nullptr with a pending Java exception. The oldest views are dropped
+    // once the pool holds more than the configured number of buffers; a view
+    // already handed out stays valid through its local reference.
+    template <typename T>
+    jobject get(const T* data, std::size_t count, JNIEnv* env) {
+        Key key{data, count * sizeof(T), &JavaBufferView<T>::classPath};
+
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = views.find(key);
+        if (found != views.end()) {
+            return env->NewLocalRef(found->second);
+        }
+
+        auto view = createView(data, key.bytes, env);
+        if (view == nullptr) {
+            return nullptr;
+        }
+        views.emplace(key, env->NewGlobalRef(view));
+        insertionOrder.push_back(key);
+        while (views.size() > capacity) {
+            evict(insertionOrder.front(), env);
+            insertionOrder.pop_front();
+        }
+        return view;
+    }
+
+    // A view that is not pooled, for memory whose address or size changes
+    // from call to call: a local reference owned by the caller, or nullptr
+    // with a pending Java exception.
+    template <typename T>
+    jobject create(const T* data, std::size_t count, JNIEnv* env) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return createView(data, count * sizeof(T), env);
+    }
+
+    void setCapacity(std::size_t maxViews) {
+        std::lock_guard<std::mutex> lock(mutex);
+        capacity = maxViews;
+    }
+
+    // Drops every view over memory starting at address, e.g. before freeing it.
+    void release(const void* address, JNIEnv* env) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = views.begin(); it != views.end();) {
+            if (it->first.address == address) {
+                env->DeleteGlobalRef(it->second);
+                it = views.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        insertionOrder.erase(std::remove_if(insertionOrder.begin(), insertionOrder.end(), [&](const Key& key) {
+            return key.address == address;
+        }), insertionOrder.end());
+    }
+
+    // Deletes every global reference; must run before the JVM is destroyed.
+    void clear(JNIEnv* env) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [key, view] : views) {
+            env->DeleteGlobalRef(view);
+        }
+        views.clear();
+        insertionOrder.clear();
+        if (nativeOrder != nullptr) {
+            env->DeleteGlobalRef(nativeOrder);
+            nativeOrder = nullptr;
+        }
+    }
+
+private:
+    JavaDirectBufferPool() = default;
+
+    // A native-order view as a local reference; called with the mutex held,
+    // which also guards nativeOrder.
+    template <typename T>
+    jobject createView(const T* data, std::size_t bytes, JNIEnv* env) {
+        using View = JavaBufferView<T>;
+        auto byteBuffer = env->NewDirectByteBuffer(const_cast<T*>(data), static_cast<jlong>(bytes));
+        if (byteBuffer == nullptr) {
+            return nullptr;
+        }
+        auto& byteBufferClass = JavaClassRegistry::getInstance().get("java/nio/ByteBuffer");
+        auto byteBufferClassId = ensureNativeOrder(env) ? JavaClassRegistry::getInstance().resolve(byteBufferClass, env) : nullptr;
+        auto orderMethod = byteBufferClassId == nullptr ? nullptr : byteBufferClass.methods.get("order", "(Ljava/nio/ByteOrder;)Ljava/nio/ByteBuffer;", [&] {
+            return env->GetMethodID(byteBufferClassId, "order", "(Ljava/nio/ByteOrder;)Ljava/nio/ByteBuffer;");
+        });
+        if (orderMethod == nullptr) {
+            env->DeleteLocalRef(byteBuffer);
+            return nullptr;
+        }
+        env->DeleteLocalRef(env->CallObjectMethod(byteBuffer, orderMethod, nativeOrder));
+        if (env->ExceptionCheck()) {
+            env->DeleteLocalRef(byteBuffer);
+            return nullptr;
+        }
+
+        if constexpr (View::converted) {
+            static constexpr auto asSignature = JavaFixedString{"()L"} + View::classPath + JavaFixedString{";"};
+            auto asMethod = byteBufferClass.methods.get(View::asMethod, asSignature, [&] {
+                return env->GetMethodID(byteBufferClassId, View::asMethod.c_str(), asSignature.c_str());
+            });
+            auto view = asMethod == nullptr ? nullptr : env->CallObjectMethod(byteBuffer, asMethod);
+            env->DeleteLocalRef(byteBuffer);
+            return view;
+        } else {
+            return byteBuffer;
+        }
+    }
+
+    bool ensureNativeOrder(JNIEnv* env) {
+        if (nativeOrder != nullptr) {
+            return true;
+        }
+        auto& byteOrderClass = JavaClassRegistry::getInstance().get("java/nio/ByteOrder");
+        auto byteOrderClassId = JavaClassRegistry::getInstance().resolve(byteOrderClass, env);
+        if (byteOrderClassId == nullptr) {
+            return false;
+        }
+        auto nativeOrderMethod = byteOrderClass.methods.get("nativeOrder", "()Ljava/nio/ByteOrder;", [&] {
+            return env->GetStaticMethodID(byteOrderClassId, "nativeOrder", "()Ljava/nio/ByteOrder;");
+        });
+        if (nativeOrderMethod == nullptr) {
+            return false;
+        }
+        auto order = env->CallStaticObjectMethod(byteOrderClassId, nativeOrderMethod);
+        if (order == nullptr) {
+            return false;
+        }
+        nativeOrder = env->NewGlobalRef(order);
+        env->DeleteLocalRef(order);
+        return true;
+    }
+
+    void evict(const Key& key, JNIEnv* env) {
+        auto found = views.find(key);
+        if (found != views.end()) {
+            env->DeleteGlobalRef(found->second);
+            views.erase(found);
+        }
+    }
+};
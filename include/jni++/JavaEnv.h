@@ -0,0 +1,148 @@
+#pragma once
+#include <jni.h>
+#include <atomic>
+#include <stdexcept>
+
+// Hands out the JNIEnv of the calling thread. Threads the JVM does not know
+// yet are attached on first use and detached again when they exit; threads
+// attached by someone else (the creating thread, Java threads calling into
+// native code) are used as they are and never detached here.
+class JavaEnv {
+    // The environment cached for a thread is only valid for the JVM it was
+    // obtained from; unbind() starts a new generation instead of touching the
+    // thread-local caches, which may already be destroyed at process exit.
+    struct Attachment {
+        JNIEnv* env = nullptr;
+        bool owned = false;
+        unsigned generation = 0;
+
+        bool valid() const {
+            return env != nullptr && generation == currentGeneration().load(std::memory_order_acquire);
+        }
+
+        ~Attachment() {
+            auto vm = javaVM().load();
+            if (owned && vm != nullptr && valid()) {
+                vm->DetachCurrentThread();
+            }
+            env = nullptr;
+            owned = false;
+        }
+    };
+
+public:
+    // Remembers the JVM and adopts env as the calling thread's environment.
+    static void bind(JNIEnv* env) {
+        if (javaVM().load() == nullptr) {
+            JavaVM* vm = nullptr;
+            if (env->GetJavaVM(&vm) == JNI_OK) {
+                javaVM().store(vm);
+            }
+        }
+        auto& attachment = current();
+        if (!attachment.valid()) {
+            attachment = Attachment{env, false, currentGeneration().load(std::memory_order_acquire)};
+        }
+    }
+
+    // Forgets the JVM and every thread's cached environment; called right
+    // before the JVM is destroyed.
+    static void unbind() {
+        javaVM().store(nullptr);
+        currentGeneration().fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // Detaches the calling thread when it exits even though it was not
+    // attached here; for a thread that created the JVM and then finishes.
+    static void detachOnExit() {
+        auto& attachment = current();
+        if (attachment.valid()) {
+            attachment.owned = true;
+        }
+    }
+
+    // Threads attached from now on are daemon threads, so they do not keep the JVM alive.
+    static void attachAsDaemon(bool daemon) {
+        daemonThreads().store(daemon);
+    }
+
+    static JNIEnv* get() {
+        auto env = tryGet();
+        if (env == nullptr) {
+            throw std::runtime_error("No JVM available for this thread");
+        }
+        return env;
+    }
+
+    // Like get(), but returns nullptr instead of throwing when there is no JVM
+    // or the thread cannot be attached.
+    static JNIEnv* tryGet() {
+        auto& attachment = current();
+        if (attachment.valid()) {
+            return attachment.env;
+        }
+        attachment.env = nullptr;
+        attachment.owned = false;
+        auto vm = javaVM().load();
+        if (vm == nullptr) {
+            return nullptr;
+        }
+        void* env = nullptr;
+        auto status = vm->GetEnv(&env, JNI_VERSION_1_6);
+        if (status == JNI_EDETACHED) {
+            status = daemonThreads().load()
+                ? vm->AttachCurrentThreadAsDaemon(&env, nullptr)
+                : vm->AttachCurrentThread(&env, nullptr);
+            attachment.owned = status == JNI_OK;
+        }
+        if (status != JNI_OK) {
+            return nullptr;
+        }
+        attachment.env = static_cast<JNIEnv*>(env);
+        attachment.generation = currentGeneration().load(std::memory_order_acquire);
+        return attachment.env;
+    }
+
+    // The calling thread's environment as the JVM reports it, without
+    // attaching the thread or using its cache; safe during process exit.
+    static JNIEnv* attached() {
+        auto vm = javaVM().load();
+        void* env = nullptr;
+        if (vm == nullptr || vm->GetEnv(&env, JNI_VERSION_1_6) != JNI_OK) {
+            return nullptr;
+        }
+        return static_cast<JNIEnv*>(env);
+    }
+
+    // Detaches the calling thread now instead of at thread exit.
+    static void detach() {
+        auto& attachment = current();
+        auto vm = javaVM().load();
+        if (attachment.owned && vm != nullptr && attachment.valid()) {
+            vm->DetachCurrentThread();
+        }
+        attachment.env = nullptr;
+        attachment.owned = false;
+    }
+
+private:
+    static std::atomic<JavaVM*>& javaVM() {
+        static std::atomic<JavaVM*> vm{nullptr};
+        return vm;
+    }
+
+    static std::atomic<unsigned>& currentGeneration() {
+        static std::atomic<unsigned> generation{0};
+        return generation;
+    }
+
+    static std::atomic<bool>& daemonThreads() {
+        static std::atomic<bool> daemon{false};
+        return daemon;
+    }
+
+    static Attachment& current() {
+        thread_local Attachment attachment;
+        return attachment;
+    }
+};
@@ -0,0 +1,123 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaString.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// A Java throwable surfaced in C++. It keeps a global reference to the
+// original, so callers can inspect it or throw it back into Java with rethrow().
+class JavaException : public std::runtime_error {
+    std::shared_ptr<std::remove_pointer_t<jthrowable>> throwable;
+    std::string className;
+    std::string message;
+
+public:
+    JavaException(const char* where, std::string className, std::string message, jthrowable throwable)
+        : std::runtime_error(className + ": " + message + " (after " + where + ")"),
+          throwable(throwable, [](jthrowable ref) {
+              if (auto env = JavaEnv::tryGet()) {
+                  env->DeleteGlobalRef(ref);
+              }
+          }),
+          className(std::move(className)),
+          message(std::move(message)) {
+    }
+
+    // Global reference to the Java throwable; valid as long as this exception.
+    jthrowable getThrowable() const {
+        return throwable.get();
+    }
+
+    // Dotted name of the throwable's class, e.g. java.lang.IllegalStateException.
+    const std::string& getClassName() const {
+        return className;
+    }
+
+    const std::string& getMessage() const {
+        return message;
+    }
+
+    // Makes the original throwable pending again, e.g. before returning from a native method.
+    void rethrow(JNIEnv* env) const {
+        env->Throw(throwable.get());
+    }
+
+    // The no-exception path is a single ExceptionCheck; where is only turned
+    // into a string once something was thrown.
+    static void check(const char* where, JNIEnv* env) {
+        if (env->ExceptionCheck()) [[unlikely]] {
+            raise(where, env);
+        }
+    }
+
+    // Clears the pending exception and throws it as the matching C++ type.
+    [[noreturn]] static void raise(const char* where, JNIEnv* env);
+};
+
+class JavaClassNotFoundException : public JavaException {
+public:
+    using JavaException::JavaException;
+};
+
+// NoSuchMethodError or NoSuchFieldError, usually a wrong name or descriptor.
+class JavaNoSuchMemberException : public JavaException {
+public:
+    using JavaException::JavaException;
+};
+
+class JavaOutOfMemoryError : public JavaException {
+public:
+    using JavaException::JavaException;
+};
+
+inline void JavaException::raise(const char* where, JNIEnv* env) {
+    auto local = env->ExceptionOccurred();
+    env->ExceptionClear();
+    if (local == nullptr) {
+        throw std::runtime_error(std::string("Java exception vanished after ") + where);
+    }
+
+    // Reporting goes through the registry's method caches, so the class and
+    // method lookups happen once per process rather than once per failure.
+    auto& registry = JavaClassRegistry::getInstance();
+    auto describe = [&](const char* classPath, const char* method, jobject target) {
+        std::string text;
+        auto& entry = registry.get(classPath);
+        auto classId = registry.resolve(entry, env);
+        auto methodId = classId == nullptr ? nullptr : entry.methods.get(method, "()Ljava/lang/String;", [&] {
+            return env->GetMethodID(classId, method, "()Ljava/lang/String;");
+        });
+        if (methodId != nullptr) {
+            auto string = static_cast<jstring>(env->CallObjectMethod(target, methodId));
+            if (string != nullptr) {
+                JavaString::toUtf8(string, text, env);
+                env->DeleteLocalRef(string);
+            }
+        }
+        env->ExceptionClear();
+        return text;
+    };
+
+    auto localClass = env->GetObjectClass(local);
+    auto className = describe("java/lang/Class", "getName", localClass);
+    env->DeleteLocalRef(localClass);
+    auto message = describe("java/lang/Throwable", "getMessage", local);
+
+    auto throwable = static_cast<jthrowable>(env->NewGlobalRef(local));
+    env->DeleteLocalRef(local);
+
+    if (className == "java.lang.ClassNotFoundException" || className == "java.lang.NoClassDefFoundError") {
+        throw JavaClassNotFoundException(where, std::move(className), std::move(message), throwable);
+    }
+    if (className == "java.lang.NoSuchMethodError" || className == "java.lang.NoSuchFieldError") {
+        throw JavaNoSuchMemberException(where, std::move(className), std::move(message), throwable);
+    }
+    if (className == "java.lang.OutOfMemoryError") {
+        throw JavaOutOfMemoryError(where, std::move(className), std::move(message), throwable);
+    }
+    throw JavaException(where, std::move(className), std::move(message), throwable);
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaType.h>
+#include <cstdint>
+#include <string_view>
+
+// Binds a C++ primitive to the Get/Set<Type>Field functions of its Java type,
+// following the descriptors JavaType gives each C++ type. Types without an
+// entry are object-valued fields.
+template <typename T>
+struct JavaFieldAccess {
+};
+
+template <typename T, typename Native, Native (JNIEnv::*Get)(jobject, jfieldID), void (JNIEnv::*Set)(jobject, jfieldID, Native)>
+struct JavaPrimitiveFieldAccess {
+    using NativeType = Native;
+
+    static T get(JNIEnv* env, jobject object, jfieldID fieldId) {
+        return static_cast<T>((env->*Get)(object, fieldId));
+    }
+
+    static void set(JNIEnv* env, jobject object, jfieldID fieldId, T value) {
+        (env->*Set)(object, fieldId, static_cast<Native>(value));
+    }
+};
+
+template <>
+struct JavaFieldAccess<bool> : JavaPrimitiveFieldAccess<bool, jboolean, &JNIEnv::GetBooleanField, &JNIEnv::SetBooleanField> {
+};
+
+template <>
+struct JavaFieldAccess<uint8_t> : JavaPrimitiveFieldAccess<uint8_t, jshort, &JNIEnv::GetShortField, &JNIEnv::SetShortField> {
+};
+
+template <>
+struct JavaFieldAccess<int8_t> : JavaPrimitiveFieldAccess<int8_t, jchar, &JNIEnv::GetCharField, &JNIEnv::SetCharField> {
+};
+
+template <>
+struct JavaFieldAccess<int16_t> : JavaPrimitiveFieldAccess<int16_t, jshort, &JNIEnv::GetShortField, &JNIEnv::SetShortField> {
+};
+
+template <>
+struct JavaFieldAccess<uint16_t> : JavaPrimitiveFieldAccess<uint16_t, jint, &JNIEnv::GetIntField, &JNIEnv::SetIntField> {
+};
+
+template <>
+struct JavaFieldAccess<int32_t> : JavaPrimitiveFieldAccess<int32_t, jint, &JNIEnv::GetIntField, &JNIEnv::SetIntField> {
+};
+
+template <>
+struct JavaFieldAccess<uint32_t> : JavaPrimitiveFieldAccess<uint32_t, jlong, &JNIEnv::GetLongField, &JNIEnv::SetLongField> {
+};
+
+template <>
+struct JavaFieldAccess<int64_t> : JavaPrimitiveFieldAccess<int64_t, jlong, &JNIEnv::GetLongField, &JNIEnv::SetLongField> {
+};
+
+template <>
+struct JavaFieldAccess<float> : JavaPrimitiveFieldAccess<float, jfloat, &JNIEnv::GetFloatField, &JNIEnv::SetFloatField> {
+};
+
+template <>
+struct JavaFieldAccess<double> : JavaPrimitiveFieldAccess<double, jdouble, &JNIEnv::GetDoubleField, &JNIEnv::SetDoubleField> {
+};
+
+template <typename T>
+concept JavaPrimitiveField = requires(JNIEnv* env, jobject object, jfieldID fieldId) {
+    JavaFieldAccess<T>::get(env, object, fieldId);
+};
+
+// One column of a batched field transfer: the Java field name and the C++
+// container holding that field for every element. Reading resizes the
+// container to the number of elements; writing needs at least that many values.
+//
+//     std::vector<int32_t> ids;
+//     std::vector<std::string> names;
+//     trades.readFields(list, JavaFieldColumn("id", ids), JavaFieldColumn("name", names));
+template <typename Container>
+struct JavaFieldColumn {
+    using ValueType = typename Container::value_type;
+
+    static_assert(JavaHasStaticSymbol<ValueType>::value, "field columns need a compile-time descriptor");
+
+    JavaFieldColumn(std::string_view name, Container& values) : name(name), values(values) {
+    }
+
+    std::string_view name;
+    Container& values;
+};
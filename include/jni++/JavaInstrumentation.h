@@ -0,0 +1,315 @@
+#pragma once
+#include <jni.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+
+// Opt-in call statistics. Build with JNIPP_INSTRUMENTATION defined to record,
+// per (class, method, signature), the number of calls, a latency histogram and
+// the local references they create, along with process-wide method/field ID
+// cache hit rates and FindClass calls. Without it, the hooks below expand to
+// nothing and the wrapper pays no cost.
+//
+//     JavaInstrumentation::getInstance().startTrace(100000);
+//     ...
+//     JavaInstrumentation::getInstance().writeJson("jni-stats.json");
+//     JavaInstrumentation::getInstance().writeChromeTrace("jni-trace.json");
+class JavaInstrumentation {
+public:
+    // Bucket i counts calls that took less than 2^i ns (the last one, the rest).
+    static constexpr std::size_t histogramBuckets = 32;
+
+    struct MethodStats {
+        std::string classPath;
+        std::string name;
+        std::string signature;
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> totalNs{0};
+        std::atomic<std::uint64_t> localRefs{0};
+        std::array<std::atomic<std::uint64_t>, histogramBuckets> histogram{};
+    };
+
+    static JavaInstrumentation& getInstance() {
+        static JavaInstrumentation instance;
+        return instance;
+    }
+
+    JavaInstrumentation(JavaInstrumentation const&) = delete;
+    JavaInstrumentation(JavaInstrumentation&&) = delete;
+
+    // Attaches a readable name to an ID; called when the ID is first resolved.
+    void nameMethod(jmethodID methodId, std::string_view classPath, std::string_view name, std::string_view signature) {
+        if (methodId == nullptr) {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto& stats = methods[methodId];
+        if (!stats) {
+            stats = std::make_unique<MethodStats>();
+        }
+        if (stats->name.empty()) {
+            stats->classPath = classPath;
+            stats->name = name;
+            stats->signature = signature;
+        }
+    }
+
+    void recordCall(jmethodID methodId, std::chrono::steady_clock::time_point start, std::uint64_t localRefs) {
+        auto end = std::chrono::steady_clock::now();
+        auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        auto& stats = statsOf(methodId);
+        stats.calls.fetch_add(1, std::memory_order_relaxed);
+        stats.totalNs.fetch_add(ns, std::memory_order_relaxed);
+        stats.localRefs.fetch_add(localRefs, std::memory_order_relaxed);
+        stats.histogram[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        localRefCount.fetch_add(localRefs, std::memory_order_relaxed);
+        if (tracing.load(std::memory_order_relaxed)) {
+            addTraceEvent(stats, start, ns);
+        }
+    }
+
+    void recordMethodLookup(bool hit) {
+        (hit ? methodCacheHits : methodCacheMisses).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordFieldLookup(bool hit) {
+        (hit ? fieldCacheHits : fieldCacheMisses).fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordFindClass() {
+        findClassCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Keeps the last maxEvents calls for writeChromeTrace().
+    void startTrace(std::size_t maxEvents) {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        traceCapacity = maxEvents;
+        trace.clear();
+        tracing.store(maxEvents > 0, std::memory_order_relaxed);
+    }
+
+    void stopTrace() {
+        tracing.store(false, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        for (auto& [methodId, stats] : methods) {
+            stats->calls = 0;
+            stats->totalNs = 0;
+            stats->localRefs = 0;
+            for (auto& bucket : stats->histogram) {
+                bucket = 0;
+            }
+        }
+        methodCacheHits = 0;
+        methodCacheMisses = 0;
+        fieldCacheHits = 0;
+        fieldCacheMisses = 0;
+        findClassCount = 0;
+        localRefCount = 0;
+        std::lock_guard<std::mutex> traceLock(traceMutex);
+        trace.clear();
+    }
+
+    std::string toJson() const {
+        std::ostringstream out;
+        out << "{\"findClass\":" << findClassCount.load()
+            << ",\"localRefs\":" << localRefCount.load()
+            << ",\"methodCache\":";
+        writeCache(out, methodCacheHits.load(), methodCacheMisses.load());
+        out << ",\"fieldCache\":";
+        writeCache(out, fieldCacheHits.load(), fieldCacheMisses.load());
+        out << ",\"methods\":[";
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        bool first = true;
+        for (auto& [methodId, stats] : methods) {
+            auto calls = stats->calls.load();
+            if (calls == 0) {
+                continue;
+            }
+            out << (first ? "" : ",") << "{\"class\":";
+            writeString(out, stats->classPath);
+            out << ",\"method\":";
+            writeString(out, stats->name);
+            out << ",\"signature\":";
+            writeString(out, stats->signature);
+            out << ",\"calls\":" << calls
+                << ",\"totalNs\":" << stats->totalNs.load()
+                << ",\"localRefs\":" << stats->localRefs.load()
+                << ",\"histogram\":[";
+            bool firstBucket = true;
+            for (std::size_t i = 0; i < histogramBuckets; ++i) {
+                if (auto count = stats->histogram[i].load()) {
+                    out << (firstBucket ? "" : ",") << "{\"ltNs\":" << (std::uint64_t(1) << i) << ",\"count\":" << count << "}";
+                    firstBucket = false;
+                }
+            }
+            out << "]}";
+            first = false;
+        }
+        out << "]}";
+        return out.str();
+    }
+
+    // Trace Event Format, loadable in chrome://tracing or Perfetto.
+    std::string toChromeTrace() const {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[";
+        std::shared_lock<std::shared_mutex> namesLock(mutex);
+        std::lock_guard<std::mutex> lock(traceMutex);
+        bool first = true;
+        for (auto& event : trace) {
+            out << (first ? "" : ",") << "{\"name\":";
+            writeString(out, event.stats->classPath + "." + event.stats->name + event.stats->signature);
+            out << ",\"cat\":\"jni\",\"ph\":\"X\",\"pid\":1,\"tid\":" << event.thread
+                << ",\"ts\":" << event.startNs / 1000.0
+                << ",\"dur\":" << event.durationNs / 1000.0 << "}";
+            first = false;
+        }
+        out << "]}";
+        return out.str();
+    }
+
+    void writeJson(const std::string& path) const {
+        write(path, toJson());
+    }
+
+    void writeChromeTrace(const std::string& path) const {
+        write(path, toChromeTrace());
+    }
+
+private:
+    struct TraceEvent {
+        const MethodStats* stats;
+        std::uint64_t thread;
+        std::uint64_t startNs;
+        std::uint64_t durationNs;
+    };
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<jmethodID, std::unique_ptr<MethodStats>> methods;
+    std::atomic<std::uint64_t> methodCacheHits{0};
+    std::atomic<std::uint64_t> methodCacheMisses{0};
+    std::atomic<std::uint64_t> fieldCacheHits{0};
+    std::atomic<std::uint64_t> fieldCacheMisses{0};
+    std::atomic<std::uint64_t> findClassCount{0};
+    std::atomic<std::uint64_t> localRefCount{0};
+
+    mutable std::mutex traceMutex;
+    std::atomic<bool> tracing{false};
+    std::size_t traceCapacity = 0;
+    std::deque<TraceEvent> trace;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+    JavaInstrumentation() = default;
+
+    MethodStats& statsOf(jmethodID methodId) {
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            auto found = methods.find(methodId);
+            if (found != methods.end()) {
+                return *found->second;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto& stats = methods[methodId];
+        if (!stats) {
+            stats = std::make_unique<MethodStats>();
+        }
+        return *stats;
+    }
+
+    static std::size_t bucketOf(std::uint64_t ns) {
+        std::size_t bucket = 0;
+        while (bucket + 1 < histogramBuckets && ns >= (std::uint64_t(1) << bucket)) {
+            ++bucket;
+        }
+        return bucket;
+    }
+
+    void addTraceEvent(const MethodStats& stats, std::chrono::steady_clock::time_point start, std::uint64_t durationNs) {
+        static std::atomic<std::uint64_t> threadCount{0};
+        thread_local std::uint64_t thread = ++threadCount;
+        auto startNs = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(start - epoch).count());
+        std::lock_guard<std::mutex> lock(traceMutex);
+        if (traceCapacity == 0) {
+            return;
+        }
+        if (trace.size() == traceCapacity) {
+            trace.pop_front();
+        }
+        trace.push_back(TraceEvent{&stats, thread, startNs, durationNs});
+    }
+
+    static void writeCache(std::ostringstream& out, std::uint64_t hits, std::uint64_t misses) {
+        auto lookups = hits + misses;
+        out << "{\"hits\":" << hits << ",\"misses\":" << misses
+            << ",\"hitRate\":" << (lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups)) << "}";
+    }
+
+    static void writeString(std::ostringstream& out, std::string_view value) {
+        out << '"';
+        for (auto c : value) {
+            if (c == '"' || c == '\\') {
+                out << '\\';
+            }
+            out << c;
+        }
+        out << '"';
+    }
+
+    static void write(const std::string& path, const std::string& contents) {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        file << contents;
+    }
+};
+
+// Times the enclosing call and files it under methodId when it goes out of scope.
+class JavaCallScope {
+    jmethodID methodId;
+    std::uint64_t localRefs;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    JavaCallScope(jmethodID methodId, std::uint64_t localRefs)
+        : methodId(methodId), localRefs(localRefs), start(std::chrono::steady_clock::now()) {
+    }
+
+    JavaCallScope(JavaCallScope const&) = delete;
+    JavaCallScope& operator=(JavaCallScope const&) = delete;
+
+    ~JavaCallScope() {
+        JavaInstrumentation::getInstance().recordCall(methodId, start, localRefs);
+    }
+};
+
+#ifdef JNIPP_INSTRUMENTATION
+#define JNIPP_CALL_SCOPE(methodId, localRefs) JavaCallScope jnippCallScope(methodId, localRefs)
+#define JNIPP_NAME_METHOD(methodId, classPath, name, signature) JavaInstrumentation::getInstance().nameMethod(methodId, classPath, name, signature)
+#define JNIPP_RECORD_LOOKUP(Id, hit) \
+    ((std::is_same_v<Id, jmethodID>) ? JavaInstrumentation::getInstance().recordMethodLookup(hit) : JavaInstrumentation::getInstance().recordFieldLookup(hit))
+#define JNIPP_RECORD_FIND_CLASS() JavaInstrumentation::getInstance().recordFindClass()
+#else
+#define JNIPP_CALL_SCOPE(methodId, localRefs) ((void)0)
+#define JNIPP_NAME_METHOD(methodId, classPath, name, signature) ((void)0)
+#define JNIPP_RECORD_LOOKUP(Id, hit) ((void)0)
+#define JNIPP_RECORD_FIND_CLASS() ((void)0)
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaObj.h>
+#include <stdexcept>
+
+// Scoped PushLocalFrame/PopLocalFrame. Every local reference created on this
+// thread while the frame is alive is released when it goes out of scope,
+// except a result explicitly handed back through pop().
+//
+//     JavaObj best;
+//     {
+//         JavaLocalFrame frame(64);
+//         for (...) { ... }
+//         best = frame.pop(candidate);
+//     }
+class JavaLocalFrame {
+    JNIEnv* env;
+    bool active;
+
+public:
+    explicit JavaLocalFrame(jint capacity = 16) : env(JavaEnv::get()), active(false) {
+        if (env->PushLocalFrame(capacity) != JNI_OK) {
+            env->ExceptionClear();
+            throw std::runtime_error("PushLocalFrame failed");
+        }
+        active = true;
+    }
+
+    JavaLocalFrame(JavaLocalFrame const&) = delete;
+    JavaLocalFrame& operator=(JavaLocalFrame const&) = delete;
+
+    ~JavaLocalFrame() {
+        if (active) {
+            env->PopLocalFrame(nullptr);
+        }
+    }
+
+    // Pops the frame now; survivor is returned as a local reference in the enclosing frame.
+    jobject pop(jobject survivor = nullptr) {
+        if (!active) {
+            throw std::logic_error("JavaLocalFrame already popped");
+        }
+        active = false;
+        return env->PopLocalFrame(survivor);
+    }
+
+    JavaObj pop(const JavaObj& survivor) {
+        auto objId = pop(survivor.getObjId());
+        return JavaObj(survivor.getClassEntry(), objId, env);
+    }
+};
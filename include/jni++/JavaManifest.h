@@ -0,0 +1,127 @@
+#pragma once
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// The classes and (member, descriptor) pairs a process resolved, one per line
+// in the order they were first resolved:
+//
+//     class jnipp/bench/Fixture
+//     method jnipp/bench/Fixture add (II)I
+//     static jnipp/bench/Fixture staticScale (FF)F
+//     field jnipp/bench/Fixture value I
+//
+// A registry records into a manifest while one is attached to it, and
+// JavaClassRegistry::prewarm replays one, so a later start resolves all of
+// it up front instead of on the first calls.
+class JavaManifest {
+public:
+    enum class Kind {
+        Class,
+        Method,
+        StaticMethod,
+        Field
+    };
+
+    struct Entry {
+        Kind kind;
+        std::string classPath;
+        std::string name;
+        std::string signature;
+    };
+
+    JavaManifest() = default;
+
+    JavaManifest(JavaManifest const&) = delete;
+    JavaManifest& operator=(JavaManifest const&) = delete;
+
+    // Adds the entries of a manifest file. A missing file adds nothing, as on a first start.
+    void read(const std::string& path) {
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            std::istringstream fields(line);
+            std::string kind;
+            Entry entry;
+            fields >> kind >> entry.classPath >> entry.name >> entry.signature;
+            if (entry.classPath.empty()) {
+                continue;
+            }
+            if (kind == "class") {
+                add(Kind::Class, entry.classPath);
+            } else if (!entry.signature.empty() && kind == "method") {
+                add(Kind::Method, entry.classPath, entry.name, entry.signature);
+            } else if (!entry.signature.empty() && kind == "static") {
+                add(Kind::StaticMethod, entry.classPath, entry.name, entry.signature);
+            } else if (!entry.signature.empty() && kind == "field") {
+                add(Kind::Field, entry.classPath, entry.name, entry.signature);
+            }
+        }
+    }
+
+    // Adds the entry unless it is already listed.
+    void add(Kind kind, std::string_view classPath, std::string_view name = {}, std::string_view signature = {}) {
+        auto line = format(kind, classPath, name, signature);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lines.insert(line).second) {
+            entries.push_back(Entry{kind, std::string(classPath), std::string(name), std::string(signature)});
+        }
+    }
+
+    std::vector<Entry> getEntries() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.size();
+    }
+
+    std::string toString() const {
+        std::string text;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& entry : entries) {
+            text += format(entry.kind, entry.classPath, entry.name, entry.signature);
+            text += '\n';
+        }
+        return text;
+    }
+
+    void write(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        file << toString();
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<Entry> entries;
+    std::unordered_set<std::string> lines;
+
+    static std::string format(Kind kind, std::string_view classPath, std::string_view name, std::string_view signature) {
+        std::string line;
+        switch (kind) {
+        case Kind::Class: line = "class "; break;
+        case Kind::Method: line = "method "; break;
+        case Kind::StaticMethod: line = "static "; break;
+        case Kind::Field: line = "field "; break;
+        }
+        line += classPath;
+        if (kind != Kind::Class) {
+            line += ' ';
+            line += name;
+            line += ' ';
+            line += signature;
+        }
+        return line;
+    }
+};
@@ -0,0 +1,192 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaCall.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaInstrumentation.h>
+#include <jni++/JavaObj.h>
+#include <jni++/JavaType.h>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+// Common part of the pre-bound method handles: the jmethodID, resolved once,
+// and the JNI call variant, picked at compile time from the return type.
+template <typename R, typename... Args>
+class JavaBoundMethod {
+protected:
+    using Call = JavaCallTraits<R>;
+
+    // Object results keep the type they were bound with (a JavaObj carries
+    // its class); the other results need nothing.
+    struct Unconverted {
+    };
+
+    using ResultType = std::conditional_t<Call::converted, R, Unconverted>;
+
+    jmethodID methodId;
+    [[no_unique_address]] ResultType resultType;
+
+    JavaBoundMethod(jmethodID methodId, ResultType resultType) : methodId(methodId), resultType(std::move(resultType)) {
+    }
+
+    template <typename Invoke>
+    R invoke(const char* where, Invoke&& invoke, const Args&... args) const {
+        auto env = JavaEnv::get();
+        JNIPP_CALL_SCOPE(methodId, (JavaClass::localRefsOf<R, Args...>()));
+        auto jvalues = JavaClass::createJValues(args...);
+        if constexpr (std::is_void_v<R>) {
+            invoke(env, jvalues.data());
+            JavaException::check(where, env);
+        } else {
+            auto result = invoke(env, jvalues.data());
+            JavaException::check(where, env);
+            if constexpr (Call::converted) {
+                return JavaClass::convertResult(result, resultType);
+            } else {
+                return result;
+            }
+        }
+    }
+
+public:
+    using Signature = JavaSignature<R, Args...>;
+
+    jmethodID getMethodID() const {
+        return methodId;
+    }
+
+    // The descriptor to bind with: types with a compile-time descriptor need
+    // nothing, the others are described by sample values, as in call().
+    static std::string_view descriptor() requires Signature::isStatic {
+        return Signature::get();
+    }
+
+    template <typename Result = R>
+    static std::string_view descriptor(const std::type_identity_t<Result>& returnType, const Args&... args) requires (!std::is_void_v<Result>) {
+        return Signature::get(&returnType, args...);
+    }
+
+    static std::string_view descriptor(const Args&... args) requires (std::is_void_v<R> && sizeof...(Args) > 0) {
+        return Signature::get(nullptr, args...);
+    }
+
+    static ResultType resultTypeOf() {
+        return ResultType();
+    }
+
+    template <typename First, typename... Rest>
+    static ResultType resultTypeOf(const First& first, const Rest&...) {
+        if constexpr (Call::converted) {
+            return first;
+        } else {
+            return ResultType();
+        }
+    }
+};
+
+template <typename Signature>
+class JavaStaticMethod;
+
+template <typename Signature>
+class JavaMethod;
+
+template <typename Signature>
+class JavaNonvirtualMethod;
+
+// Handle on a static method, from JavaClass::bind.
+//
+//     auto scale = clazz.bind<float(float, float)>("scale");
+//     float r = scale(1.0f, 2.0f);
+template <typename R, typename... Args>
+class JavaStaticMethod<R(Args...)> : public JavaBoundMethod<R, Args...> {
+    using Base = JavaBoundMethod<R, Args...>;
+
+    jclass classId;
+
+public:
+    JavaStaticMethod(jclass classId, jmethodID methodId, typename Base::ResultType resultType)
+        : Base(methodId, std::move(resultType)), classId(classId) {
+    }
+
+    R operator()(const Args&... args) const {
+        return this->invoke("JavaStaticMethod call", [this](JNIEnv* env, const jvalue* values) {
+            return Base::Call::callStatic(env, classId, this->methodId, values);
+        }, args...);
+    }
+};
+
+// Handle on an instance method of one object, from JavaObj::bind. It holds
+// the object's reference without owning it: bind on a share()d JavaObj to
+// keep the handle beyond the current local frame.
+//
+//     auto add = obj.bind<int32_t(int32_t, int32_t)>("add");
+//     int32_t sum = add(1, 2);
+template <typename R, typename... Args>
+class JavaMethod<R(Args...)> : public JavaBoundMethod<R, Args...> {
+    using Base = JavaBoundMethod<R, Args...>;
+
+    jobject objId;
+
+public:
+    JavaMethod(jobject objId, jmethodID methodId, typename Base::ResultType resultType)
+        : Base(methodId, std::move(resultType)), objId(objId) {
+    }
+
+    R operator()(const Args&... args) const {
+        return this->invoke("JavaMethod call", [this](JNIEnv* env, const jvalue* values) {
+            return Base::Call::call(env, objId, this->methodId, values);
+        }, args...);
+    }
+};
+
+// Handle calling exactly the implementation declared by the object's bound
+// class, skipping virtual dispatch, from JavaObj::bindNonvirtual.
+template <typename R, typename... Args>
+class JavaNonvirtualMethod<R(Args...)> : public JavaBoundMethod<R, Args...> {
+    using Base = JavaBoundMethod<R, Args...>;
+
+    jobject objId;
+    jclass classId;
+
+public:
+    JavaNonvirtualMethod(jobject objId, jclass classId, jmethodID methodId, typename Base::ResultType resultType)
+        : Base(methodId, std::move(resultType)), objId(objId), classId(classId) {
+    }
+
+    R operator()(const Args&... args) const {
+        return this->invoke("JavaNonvirtualMethod call", [this](JNIEnv* env, const jvalue* values) {
+            return Base::Call::callNonvirtual(env, objId, classId, this->methodId, values);
+        }, args...);
+    }
+};
+
+template <typename Signature, typename... Types>
+inline JavaStaticMethod<Signature> JavaClass::bind(std::string_view name, const Types&... types) {
+    using Method = JavaStaticMethod<Signature>;
+    auto methodId = lookupStaticMethod(name, Method::descriptor(types...));
+    if (methodId == nullptr) {
+        checkExceptions("JavaClass::bind GetStaticMethodID");
+    }
+    return Method(classId, methodId, Method::resultTypeOf(types...));
+}
+
+template <typename Signature, typename... Types>
+inline JavaMethod<Signature> JavaObj::bind(std::string_view name, const Types&... types) {
+    using Method = JavaMethod<Signature>;
+    auto methodId = lookupMethod(name, Method::descriptor(types...));
+    if (methodId == nullptr) {
+        checkExceptions("JavaObj.bind GetMethodID");
+    }
+    return Method(objId, methodId, Method::resultTypeOf(types...));
+}
+
+template <typename Signature, typename... Types>
+inline JavaNonvirtualMethod<Signature> JavaObj::bindNonvirtual(std::string_view name, const Types&... types) {
+    using Method = JavaNonvirtualMethod<Signature>;
+    auto methodId = lookupMethod(name, Method::descriptor(types...));
+    if (methodId == nullptr) {
+        checkExceptions("JavaObj.bindNonvirtual GetMethodID");
+    }
+    return Method(objId, classId, methodId, Method::resultTypeOf(types...));
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaInstrumentation.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Open-addressing table of method or field IDs keyed by (name, descriptor), so
+// overloads get distinct slots. Lookups take string views and never allocate, throw or
+// lock: slots are atomic pointers to immutable entries, and a full table is
+// replaced by a larger one rather than rehashed in place. Superseded tables
+// are kept until clear() so a concurrent reader never sees freed memory; a
+// reader that misses a concurrent insert just resolves the ID again.
+template <typename Id>
+class JavaMemberCache {
+    struct Entry {
+        std::size_t hash = 0;
+        std::string key;
+        std::size_t nameLength = 0;
+        Id id = nullptr;
+
+        bool matches(std::string_view name, std::string_view signature) const {
+            return nameLength == name.size()
+                && key.size() == name.size() + signature.size()
+                && key.compare(0, nameLength, name) == 0
+                && key.compare(nameLength, std::string::npos, signature) == 0;
+        }
+    };
+
+    struct Table {
+        explicit Table(std::size_t capacity) : mask(capacity - 1), slots(new std::atomic<const Entry*>[capacity]) {
+            for (std::size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+    };
+
+    std::atomic<const Table*> current{nullptr};
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<std::unique_ptr<Entry>> storage;
+    mutable std::mutex writeMutex;
+
+public:
+    JavaMemberCache() = default;
+    JavaMemberCache(JavaMemberCache const&) = delete;
+    JavaMemberCache& operator=(JavaMemberCache const&) = delete;
+
+    Id find(std::string_view name, std::string_view signature) const {
+        auto table = current.load(std::memory_order_acquire);
+        if (table == nullptr) {
+            return nullptr;
+        }
+        auto hash = hashOf(name, signature);
+        for (auto index = hash & table->mask;; index = (index + 1) & table->mask) {
+            auto entry = table->slots[index].load(std::memory_order_acquire);
+            if (entry == nullptr) {
+                return nullptr;
+            }
+            if (entry->hash == hash && entry->matches(name, signature)) {
+                return entry->id;
+            }
+        }
+    }
+
+    void insert(std::string_view name, std::string_view signature, Id id) {
+        if (id == nullptr) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(writeMutex);
+        if (find(name, signature) != nullptr) {
+            return;
+        }
+        if ((storage.size() + 1) * 2 > capacity()) {
+            grow();
+        }
+        auto entry = std::make_unique<Entry>();
+        entry->hash = hashOf(name, signature);
+        entry->key.reserve(name.size() + signature.size());
+        entry->key.append(name).append(signature);
+        entry->nameLength = name.size();
+        entry->id = id;
+        place(*tables.back(), entry.get(), std::memory_order_release);
+        storage.push_back(std::move(entry));
+    }
+
+    // Returns the cached ID, or calls resolve() and remembers a non-null result.
+    template <typename Resolver>
+    Id get(std::string_view name, std::string_view signature, Resolver&& resolve) {
+        if (auto id = find(name, signature)) {
+            JNIPP_RECORD_LOOKUP(Id, true);
+            return id;
+        }
+        JNIPP_RECORD_LOOKUP(Id, false);
+        auto id = resolve();
+        insert(name, signature, id);
+        return id;
+    }
+
+    std::size_t size() const {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return storage.size();
+    }
+
+    // Forgets every ID. Not safe against concurrent lookups; meant for JVM shutdown.
+    void clear() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        current.store(nullptr, std::memory_order_release);
+        tables.clear();
+        storage.clear();
+    }
+
+private:
+    std::size_t capacity() const {
+        return tables.empty() ? 0 : tables.back()->mask + 1;
+    }
+
+    static std::size_t hashOf(std::string_view name, std::string_view signature) {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (auto c : name) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        for (auto c : signature) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        return static_cast<std::size_t>(hash);
+    }
+
+    static void place(Table& table, const Entry* entry, std::memory_order order) {
+        auto index = entry->hash & table.mask;
+        while (table.slots[index].load(std::memory_order_relaxed) != nullptr) {
+            index = (index + 1) & table.mask;
+        }
+        table.slots[index].store(entry, order);
+    }
+
+    void grow() {
+        auto table = std::make_unique<Table>(tables.empty() ? 16 : capacity() * 2);
+        for (auto& entry : storage) {
+            place(*table, entry.get(), std::memory_order_relaxed);
+        }
+        current.store(table.get(), std::memory_order_release);
+        tables.push_back(std::move(table));
+    }
+};
+
+using JavaMethodCache = JavaMemberCache<jmethodID>;
+using JavaFieldCache = JavaMemberCache<jfieldID>;
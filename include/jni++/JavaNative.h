@@ -0,0 +1,311 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaArray.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaString.h>
+#include <jni++/JavaType.h>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Thread-local stack of reusable strings. Each native argument takes the next
+// free buffer for the duration of the call, so nested upcalls never share one
+// and a warmed-up thread converts strings without allocating.
+template <typename String>
+class JavaNativeScratch {
+    String* buffer;
+
+public:
+    JavaNativeScratch() {
+        auto& pool = buffers();
+        if (depth() == pool.size()) {
+            pool.emplace_back();
+        }
+        buffer = &pool[depth()++];
+    }
+
+    JavaNativeScratch(JavaNativeScratch const&) = delete;
+    JavaNativeScratch& operator=(JavaNativeScratch const&) = delete;
+
+    ~JavaNativeScratch() {
+        --depth();
+    }
+
+    String& get() const {
+        return *buffer;
+    }
+
+private:
+    static std::deque<String>& buffers() {
+        thread_local std::deque<String> pool;
+        return pool;
+    }
+
+    static std::size_t& depth() {
+        thread_local std::size_t used = 0;
+        return used;
+    }
+};
+
+// Converts one value between its JNI form and the C++ type a native function
+// uses. An instance wraps one incoming argument for the length of the call;
+// toJni converts a result on its way back to Java.
+template <typename T>
+struct JavaNativeValue;
+
+template <typename T, typename Jni>
+struct JavaNativePrimitive {
+    using JniType = Jni;
+
+    JniType value;
+
+    JavaNativePrimitive(JniType value, JNIEnv*) : value(value) {
+    }
+
+    T get() const {
+        return static_cast<T>(value);
+    }
+
+    static JniType toJni(T value, JNIEnv*) {
+        return static_cast<JniType>(value);
+    }
+};
+
+// The JNI types follow the descriptors JavaType gives each C++ type.
+template <>
+struct JavaNativeValue<bool> : JavaNativePrimitive<bool, jboolean> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<uint8_t> : JavaNativePrimitive<uint8_t, jshort> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<int8_t> : JavaNativePrimitive<int8_t, jchar> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<int16_t> : JavaNativePrimitive<int16_t, jshort> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<uint16_t> : JavaNativePrimitive<uint16_t, jint> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<int32_t> : JavaNativePrimitive<int32_t, jint> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<uint32_t> : JavaNativePrimitive<uint32_t, jlong> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<int64_t> : JavaNativePrimitive<int64_t, jlong> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<float> : JavaNativePrimitive<float, jfloat> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<double> : JavaNativePrimitive<double, jdouble> {
+    using JavaNativePrimitive::JavaNativePrimitive;
+};
+
+template <>
+struct JavaNativeValue<std::string> {
+    using JniType = jstring;
+
+    JavaNativeScratch<std::string> scratch;
+
+    JavaNativeValue(jstring value, JNIEnv* env) {
+        JavaString::toUtf8(value, scratch.get(), env);
+    }
+
+    const std::string& get() const {
+        return scratch.get();
+    }
+
+    static jstring toJni(std::string_view value, JNIEnv* env) {
+        return JavaString::fromUtf8(value, env);
+    }
+};
+
+template <>
+struct JavaNativeValue<std::string_view> : JavaNativeValue<std::string> {
+    using JavaNativeValue<std::string>::JavaNativeValue;
+};
+
+template <>
+struct JavaNativeValue<const char*> : JavaNativeValue<std::string> {
+    using JavaNativeValue<std::string>::JavaNativeValue;
+
+    const char* get() const {
+        return scratch.get().c_str();
+    }
+
+    static jstring toJni(const char* value, JNIEnv* env) {
+        return JavaString::fromUtf8(value, env);
+    }
+};
+
+template <>
+struct JavaNativeValue<std::u16string> {
+    using JniType = jstring;
+
+    JavaNativeScratch<std::u16string> scratch;
+
+    JavaNativeValue(jstring value, JNIEnv* env) {
+        JavaString::toUtf16(value, scratch.get(), env);
+    }
+
+    const std::u16string& get() const {
+        return scratch.get();
+    }
+
+    static jstring toJni(std::u16string_view value, JNIEnv* env) {
+        return JavaString::fromUtf16(value, env);
+    }
+};
+
+template <>
+struct JavaNativeValue<std::u16string_view> : JavaNativeValue<std::u16string> {
+    using JavaNativeValue<std::u16string>::JavaNativeValue;
+};
+
+// Arrays are handed over as a JavaArray handle on the Java array: nothing is
+// copied unless the function reads it, possibly through critical().
+template <typename T>
+struct JavaNativeValue<JavaArray<T>> {
+    using JniType = typename JavaArrayElement<T>::ArrayType;
+
+    JniType value;
+
+    JavaNativeValue(JniType value, JNIEnv*) : value(value) {
+    }
+
+    JavaArray<T> get() const {
+        return JavaArray<T>(value);
+    }
+
+    static JniType toJni(const JavaArray<T>& value, JNIEnv*) {
+        return static_cast<JniType>(value.getObjId());
+    }
+};
+
+template <>
+struct JavaNativeValue<void> {
+    using JniType = void;
+};
+
+// Return and parameter types of a function pointer or captureless lambda.
+template <typename Function>
+struct JavaNativeFunction : JavaNativeFunction<decltype(&Function::operator())> {
+};
+
+template <typename R, typename... Args>
+struct JavaNativeFunction<R (*)(Args...)> {
+    template <auto Function>
+    struct Trampoline;
+};
+
+template <typename R, typename... Args>
+struct JavaNativeFunction<R (*)(Args...) noexcept> : JavaNativeFunction<R (*)(Args...)> {
+};
+
+template <typename C, typename R, typename... Args>
+struct JavaNativeFunction<R (C::*)(Args...) const> : JavaNativeFunction<R (*)(Args...)> {
+};
+
+template <typename C, typename R, typename... Args>
+struct JavaNativeFunction<R (C::*)(Args...) const noexcept> : JavaNativeFunction<R (*)(Args...)> {
+};
+
+// The JNI entry point generated for Function. It receives the object (or the
+// class, for static natives) and the raw arguments, converts them, and turns a
+// C++ exception into a pending Java one: a JavaException rethrows the original
+// throwable, anything else becomes a java.lang.RuntimeException.
+template <typename R, typename... Args>
+template <auto Function>
+struct JavaNativeFunction<R (*)(Args...)>::Trampoline {
+    using Result = JavaNativeValue<std::remove_cvref_t<R>>;
+
+    static_assert(JavaSignature<std::remove_cvref_t<R>, std::remove_cvref_t<Args>...>::isStatic, "native method types need a compile-time descriptor");
+
+    static std::string_view signature() {
+        return JavaSignature<std::remove_cvref_t<R>, std::remove_cvref_t<Args>...>::get();
+    }
+
+    static typename Result::JniType JNICALL call(JNIEnv* env, jobject, typename JavaNativeValue<std::remove_cvref_t<Args>>::JniType... args) {
+        JavaEnv::bind(env);
+        try {
+            if constexpr (std::is_void_v<R>) {
+                Function(JavaNativeValue<std::remove_cvref_t<Args>>(args, env).get()...);
+            } else {
+                return Result::toJni(Function(JavaNativeValue<std::remove_cvref_t<Args>>(args, env).get()...), env);
+            }
+        } catch (const JavaException& e) {
+            e.rethrow(env);
+        } catch (const std::exception& e) {
+            throwJava(env, e.what());
+        } catch (...) {
+            throwJava(env, "unknown C++ exception");
+        }
+        if constexpr (!std::is_void_v<R>) {
+            return typename Result::JniType{};
+        }
+    }
+
+private:
+    static void throwJava(JNIEnv* env, const char* message) {
+        if (env->ExceptionCheck()) {
+            return;
+        }
+        auto runtimeException = env->FindClass("java/lang/RuntimeException");
+        if (runtimeException != nullptr) {
+            env->ThrowNew(runtimeException, message);
+            env->DeleteLocalRef(runtimeException);
+        }
+    }
+};
+
+// One entry of a native method table: the Java method name and the C++
+// function implementing it, given as a function pointer or a captureless
+// lambda. Its descriptor is derived from the C++ parameter and return types.
+//
+//     clazz.registerNatives(
+//         JavaNative<&onEvent>("onEvent"),
+//         JavaNative<[](int32_t a, int32_t b) { return a + b; }>("add"));
+template <auto Function>
+class JavaNative {
+    using Trampoline = typename JavaNativeFunction<decltype(Function)>::template Trampoline<Function>;
+
+    const char* name;
+
+public:
+    constexpr explicit JavaNative(const char* name) : name(name) {
+    }
+
+    JNINativeMethod method() const {
+        JNINativeMethod method;
+        method.name = const_cast<char*>(name);
+        method.signature = const_cast<char*>(Trampoline::signature().data());
+        method.fnPtr = reinterpret_cast<void*>(&Trampoline::call);
+        return method;
+    }
+};
@@ -1,13 +1,20 @@
 #pragma once
 #include "JavaClass.h"
+#include <jni++/JavaDirectBuffer.h>
 #include <string>
 #include <functional>
+#include <memory>
+#include <type_traits>
 
+template <typename Signature>
+class JavaMethod;
+
+template <typename Signature>
+class JavaNonvirtualMethod;
 
 class JavaObj : public JavaClass {
     jobject objId;
-    std::map<std::string, jmethodID> methodCache;
-
+    std::shared_ptr<std::remove_pointer_t<jobject>> globalRef;
 
 public:
     JavaObj() : JavaClass() {
@@ -20,18 +27,35 @@ public:
         this->objId = objId;
     }
 
-    std::string getSignature() const {
-        return "L" + classPath + ";";
+    JavaObj(JavaClassEntry& classEntry, jobject objId, JNIEnv* env) : JavaClass(classEntry, env) {
+        this->objId = objId;
     }
 
-    std::string getClassPath() const {
-        return classPath;
+    std::string getSignature() const {
+        return "L" + getClassPath() + ";";
     }
 
     jobject getObjId() const {
         return objId;
     }
 
+    // Returns a copy backed by a global reference, which stays valid outside
+    // the current native frame and may be handed to another thread. The
+    // reference is deleted when the last copy goes away.
+    JavaObj share() const {
+        if (globalRef) {
+            return *this;
+        }
+        JavaObj shared(*this);
+        shared.objId = getEnv()->NewGlobalRef(objId);
+        shared.globalRef.reset(shared.objId, [](jobject ref) {
+            if (auto env = JavaEnv::tryGet()) {
+                env->DeleteGlobalRef(ref);
+            }
+        });
+        return shared;
+    }
+
     /*    template <typename... Args>
         auto getVoidMethod(std::string name, Args&&... args) {
             auto methodId = getVoidMethodID(name, args...);
@@ -39,204 +63,203 @@ public:
         }
         */
     template <typename ReturnType, typename... Args>
-    ReturnType call(std::string name, ReturnType returnType, Args&&... args) {
+    ReturnType call(std::string_view name, const ReturnType& returnType, Args&&... args) {
         auto methodId = getMethodID(name, returnType, args...);
-        checkExceptions("JavaObj.call GetMethodId");
+        if (methodId == nullptr) {
+            checkExceptions("JavaObj.call GetMethodID");
+        }
         return call(methodId, returnType, args...);
     }
 
     template <typename ReturnType, typename... Args>
     ReturnType call(jmethodID methodId, const ReturnType& returnType, Args&&... args) {
+        JNIPP_CALL_SCOPE(methodId, (localRefsOf<ReturnType, Args...>()));
         auto jvalues = createJValues(args...);
-        auto result = callMethod(methodId, returnType, jvalues.get());
+        auto result = callMethod(methodId, returnType, jvalues.data());
         checkExceptions("JavaObj.call callMethod");
         return result;
     }
 
     template <typename... Args>
-    void callVoid(std::string name, Args&&... args) {
-        callVoid(getVoidMethodID(name, args...), args...);
+    void callVoid(std::string_view name, Args&&... args) {
+        auto methodId = getVoidMethodID(name, args...);
+        if (methodId == nullptr) {
+            checkExceptions("JavaObj.callVoid GetMethodID");
+        }
+        callVoid(methodId, args...);
     }
 
     template <typename... Args>
     void callVoid(jmethodID methodId, Args&&... args) {
-        checkExceptions("JavaObj.callVoid GetMethodId");
+        JNIPP_CALL_SCOPE(methodId, (localRefsOf<void, Args...>()));
         auto jvalues = createJValues(args...);
-        callVoidMethod(methodId, jvalues.get());
+        callVoidMethod(methodId, jvalues.data());
         checkExceptions("JavaObj.callVoid callVoidMethod");
     }
 
 
     template <typename ReturnType, typename... Args>
-    jmethodID getMethodID(std::string methodName, const ReturnType& returnType, Args&&... args) {
-        return getMethodID(methodName, signature(returnType, args...));
+    jmethodID getMethodID(std::string_view methodName, const ReturnType& returnType, Args&&... args) {
+        return lookupMethod(methodName, signature(returnType, args...));
     }
 
     template <typename... Args>
-    jmethodID getVoidMethodID(std::string methodName, Args&&... args) {
-        return getMethodID(methodName, voidSignature(args...));
+    jmethodID getVoidMethodID(std::string_view methodName, Args&&... args) {
+        return lookupMethod(methodName, voidSignature(args...));
     }
 
+    // Instance counterparts of JavaClass::bind, defined in JavaMethod.h. The
+    // nonvirtual handle runs this class's implementation even when the object
+    // overrides it.
+    template <typename Signature, typename... Types>
+    JavaMethod<Signature> bind(std::string_view name, const Types&... types);
 
+    template <typename Signature, typename... Types>
+    JavaNonvirtualMethod<Signature> bindNonvirtual(std::string_view name, const Types&... types);
 
-    template <typename BufferType>
-    auto createDirectBuffer(const BufferType& buffer) {
-        auto javaByteBuffer = JavaObj("java.nio.ByteBuffer", env->NewDirectByteBuffer(const_cast<void*>(reinterpret_cast<const void*>(buffer.data())), buffer.size() * sizeof(BufferType::value_type)), env);
-        checkExceptions("linkBuffer NewDirectByteBuffer");
+    // Instance counterpart of JavaClass::callBatch.
+    template <typename Results, typename... Columns>
+    void callBatch(std::string_view name, Results& results, const Columns&... columns) {
+        if (results.size() == 0) {
+            return;
+        }
+        JavaBatchArguments<Results, Columns...> arguments(results, columns...);
+        if (!arguments.valid()) {
+            checkExceptions("JavaObj.callBatch direct buffers");
+        }
+        auto methodId = lookupMethod(name, JavaBatchArguments<Results, Columns...>::descriptor);
+        if (methodId == nullptr) {
+            checkExceptions("JavaObj.callBatch GetMethodID");
+        }
+        JNIPP_CALL_SCOPE(methodId, 0);
+        callVoidMethod(methodId, arguments.data());
+        checkExceptions("JavaObj.callBatch callVoidMethod");
+    }
 
-        auto byteNativeOrder = JavaClass("java.nio.ByteOrder", env).call("nativeOrder", JavaObj("java.nio.ByteOrder"));
-        javaByteBuffer.call("order", JavaObj("java.nio.ByteBuffer"), byteNativeOrder);
+    template <typename FieldType>
+    FieldType getField(std::string_view fieldName, const FieldType& fieldType) const {
+        auto fieldId = getFieldID(fieldName, fieldType);
+        if (fieldId == nullptr) {
+            checkExceptions("JavaObj.getField GetFieldID");
+        }
+        return getField(fieldId, fieldType);
+    }
 
-        return JavaObj("java.nio.Buffer", convertBufferType<typename BufferType::value_type>(javaByteBuffer.getObjId()), env);
+    template <typename FieldType>
+    FieldType getField(jfieldID fieldId, const FieldType& fieldType) const {
+        return readField(objId, fieldId, fieldType);
     }
 
-    template <typename BufferType>
-    void linkBuffer(std::string fieldName, const BufferType& buffer) {
-        auto bufferId = env->GetFieldID(classId, fieldName.c_str(), getBufferName<typename BufferType::value_type>("Ljava/nio/", ";").c_str());
-        checkExceptions("linkBuffer GetFieldId");
-        
-        auto javaBuffer = createDirectBuffer(buffer);
-        env->SetObjectField(objId, bufferId, javaBuffer.getObjId());
-        checkExceptions("linkBuffer SetObjectField");
+    template <typename FieldType>
+    void setField(std::string_view fieldName, const FieldType& value) {
+        auto fieldId = getFieldID(fieldName, value);
+        if (fieldId == nullptr) {
+            checkExceptions("JavaObj.setField GetFieldID");
+        }
+        setField(fieldId, value);
     }
 
-private:
-    template <typename DataType>
-    std::string getBufferName(std::string prolog, std::string punct) {
-        return prolog + "ByteBuffer" + punct;
+    void setField(std::string_view fieldName, const char* value) {
+        setField<const char*>(fieldName, value);
     }
 
-    template <typename DataType>
-    static std::string getBufferMethodName() {
-        return "";
+    template <typename FieldType>
+    void setField(jfieldID fieldId, const FieldType& value) {
+        writeField(objId, fieldId, value);
+        checkExceptions("JavaObj.setField");
     }
 
-    template <typename DataType>
-    auto convertBufferType(jobject buffer) {
-        return buffer;
+    // Native-order java.nio view over the container's memory (FloatBuffer for
+    // float, IntBuffer for int32_t, ...), taken from JavaDirectBufferPool.
+    template <typename BufferType>
+    auto createDirectBuffer(const BufferType& buffer) {
+        using DataType = typename BufferType::value_type;
+        auto env = getEnv();
+        auto view = JavaDirectBufferPool::getInstance().get(buffer.data(), buffer.size(), env);
+        checkExceptions("createDirectBuffer JavaDirectBufferPool");
+        return JavaObj(JavaBufferView<DataType>::classPath.c_str(), view, env);
     }
 
-    jmethodID getMethodID(std::string methodName, std::string signature) {
-        try {
-            return methodCache.at(methodName);
+    template <typename BufferType>
+    void linkBuffer(std::string fieldName, const BufferType& buffer) {
+        using DataType = typename BufferType::value_type;
+        static constexpr auto descriptor = JavaFixedString{"L"} + JavaBufferView<DataType>::classPath + JavaFixedString{";"};
+        auto env = getEnv();
+        auto bufferId = lookupField(fieldName, descriptor);
+        if (bufferId == nullptr) {
+            checkExceptions("linkBuffer GetFieldID");
         }
-        catch (std::out_of_range) {
-            auto methodId = env->GetMethodID(classId, methodName.c_str(), signature.c_str());
-            methodCache[methodName] = methodId;
+
+        auto view = JavaDirectBufferPool::getInstance().get(buffer.data(), buffer.size(), env);
+        checkExceptions("linkBuffer JavaDirectBufferPool");
+        env->SetObjectField(objId, bufferId, view);
+        env->DeleteLocalRef(view);
+        checkExceptions("linkBuffer SetObjectField");
+    }
+
+private:
+    jmethodID lookupMethod(std::string_view methodName, std::string_view signature) {
+        return classEntry->methods.get(methodName, signature, [&] {
+            auto methodId = getEnv()->GetMethodID(classId, std::string(methodName).c_str(), signature.data());
+            JNIPP_NAME_METHOD(methodId, getClassPath(), methodName, signature);
+            if (methodId != nullptr) {
+                classEntry->registry.recordMember(JavaManifest::Kind::Method, *classEntry, methodName, signature);
+            }
             return methodId;
-        }
+        });
     }
 
     template <typename ReturnType>
-    ReturnType callMethod(jmethodID methodId, const ReturnType& returnType, jvalue* args) const {
-        return ReturnType(returnType.getClassPath(), callMethod(methodId, jobject(), args), env);
-    };
-
-    void callVoidMethod(jmethodID methodId, jvalue* args) const {
-        env->CallVoidMethodA(objId, methodId, args);
+    ReturnType callMethod(jmethodID methodId, const ReturnType& returnType, const jvalue* args) const {
+        using Call = JavaCallTraits<ReturnType>;
+        auto result = Call::call(getEnv(), objId, methodId, args);
+        if constexpr (Call::converted) {
+            checkExceptions("JavaObj.callMethod CallObjectMethodA");
+            return convertResult(result, returnType);
+        } else {
+            return result;
+        }
     }
 
-    template <typename DataType>
-    auto convertBufferTypeHelper(jobject buffer) {
-        auto asTypeBuffer = env->GetMethodID(env->GetObjectClass(buffer), getBufferName<DataType>("as", "").c_str(), getBufferName<DataType>("()Ljava/nio/", ";").c_str());
-        checkExceptions("convertBufferTypeHelper GetMethodID");
-        auto convertedBuffer = env->CallObjectMethod(buffer, asTypeBuffer);
-        checkExceptions("convertBufferTypeHelper CallObjectMethod");
-        return convertedBuffer;
+    void callVoidMethod(jmethodID methodId, const jvalue* args) const {
+        JavaCallTraits<void>::call(getEnv(), objId, methodId, args);
     }
 };
 
-template <>
-inline std::string JavaObj::getBufferName<uint16_t>(std::string prolog, std::string punct) {
-    return prolog + "ShortBuffer" + punct;
-}
-
-template <>
-inline std::string JavaObj::getBufferName<uint32_t>(std::string prolog, std::string punct) {
-    return prolog + "IntBuffer" + punct;
-}
-
-template <>
-inline std::string JavaObj::getBufferName<uint64_t>(std::string prolog, std::string punct) {
-    return prolog + "LongBuffer" + punct;
-}
-
-
-template <>
-inline auto JavaObj::convertBufferType<uint16_t>(jobject buffer) {
-    return convertBufferTypeHelper<uint16_t>(buffer);
-}
-
-template <>
-inline auto JavaObj::convertBufferType<uint32_t>(jobject buffer) {
-    return convertBufferTypeHelper<uint32_t>(buffer);
-}
-
-template <>
-inline auto JavaObj::convertBufferType<uint64_t>(jobject buffer) {
-    return convertBufferTypeHelper<uint64_t>(buffer);
-}
-
-
-template <>
-inline jobject JavaObj::callMethod(jmethodID methodId, const jobject&, jvalue* args) const {
-    return env->CallObjectMethodA(objId, methodId, args);
-}
-
-template <>
-inline bool JavaObj::callMethod(jmethodID methodId, const bool&, jvalue* args) const {
-    return env->CallBooleanMethodA(objId, methodId, args) != 0;
-}
-
-template <>
-inline uint8_t JavaObj::callMethod(jmethodID methodId, const uint8_t&, jvalue* args) const {
-    return env->CallByteMethodA(objId, methodId, args);
-}
-
-template <>
-inline int8_t JavaObj::callMethod(jmethodID methodId, const int8_t&, jvalue* args) const {
-    return static_cast<char>(env->CallCharMethodA(objId, methodId, args));
-}
-
-template <>
-inline int16_t JavaObj::callMethod(jmethodID methodId, const int16_t&, jvalue* args) const {
-    return env->CallShortMethodA(objId, methodId, args);
-}
-
-template <>
-inline uint16_t JavaObj::callMethod(jmethodID methodId, const uint16_t&, jvalue* args) const {
-    return static_cast<uint16_t>(env->CallIntMethodA(objId, methodId, args));
-}
-
-template <>
-inline int32_t JavaObj::callMethod(jmethodID methodId, const int32_t&, jvalue* args) const {
-    return env->CallIntMethodA(objId, methodId, args);
-}
-
-template <>
-inline uint32_t JavaObj::callMethod(jmethodID methodId, const uint32_t&, jvalue* args) const {
-    return static_cast<uint32_t>(env->CallLongMethodA(objId, methodId, args));
-}
-
-template <>
-inline int64_t JavaObj::callMethod(jmethodID methodId, const int64_t&, jvalue* args) const {
-    return env->CallLongMethodA(objId, methodId, args);
-}
-
-template <>
-inline float JavaObj::callMethod(jmethodID methodId, const float&, jvalue* args) const {
-    return env->CallFloatMethodA(objId, methodId, args);
-}
-
-template <>
-inline double JavaObj::callMethod(jmethodID methodId, const double&, jvalue* args) const {
-    return env->CallDoubleMethodA(objId, methodId, args);
+template <typename... Args>
+inline JavaObj JavaClass::createNew(std::string classPath, Args&&... args) {
+    std::replace(classPath.begin(), classPath.end(), '.', '/');
+    if (!classPath.empty() && classPath != getClassPath()) {
+        throw std::invalid_argument("JavaClass::createNew: " + classPath + " is not " + getClassPath());
+    }
+    auto env = getEnv();
+    auto signature = voidSignature(args...);
+    auto methodId = classEntry->methods.get("<init>", signature, [&] {
+        auto methodId = env->GetMethodID(classId, "<init>", signature.data());
+        JNIPP_NAME_METHOD(methodId, getClassPath(), "<init>", signature);
+        if (methodId != nullptr) {
+            classEntry->registry.recordMember(JavaManifest::Kind::Method, *classEntry, "<init>", signature);
+        }
+        return methodId;
+    });
+    if (methodId == nullptr) {
+        checkExceptions("JavaClass::createNew GetMethodID");
+    }
+    JNIPP_CALL_SCOPE(methodId, (localRefsOf<JavaObj, Args...>()));
+    auto jvalues = createJValues(args...);
+    auto objId = env->NewObjectA(classId, methodId, jvalues.data());
+    checkExceptions("JavaClass::createNew NewObjectA");
+    return JavaObj(*classEntry, objId, env);
 }
 
 template <>
-inline std::string JavaClass::getSymbol(const JavaObj& obj) {
-    return obj.getSignature();
-}
+struct JavaType<JavaObj> {
+    static void appendSymbol(std::string& buffer, const JavaObj& obj) {
+        buffer += 'L';
+        buffer += obj.getClassPath();
+        buffer += ';';
+    }
+};
 
 template <>
 inline jvalue JavaClass::toJvalue(const JavaObj& v) {
@@ -0,0 +1,176 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaObj.h>
+#include <jni++/JavaType.h>
+#include <string>
+#include <utility>
+
+// Kind of JNI reference a JavaRef owns.
+enum class JavaOwnership {
+    // Valid on the creating thread until its native frame or JavaLocalFrame ends.
+    Local,
+    // Valid on any thread until released.
+    Global,
+    // Does not keep the object alive; lock() it to use it.
+    WeakGlobal
+};
+
+// A Java object handle the size of two pointers: the reference it owns and
+// the interned class entry, so holding many of them allocates nothing and
+// looks up nothing. The reference is deleted with the handle; a copy takes a
+// new reference of the same kind and a move hands it over.
+//
+//     std::vector<JavaGlobalRef> rows;
+//     for (...) {
+//         rows.push_back(cursor.call("next", JavaLocalRef(rowType)).toGlobal());
+//     }
+//     rows[0].object().call("getId", int64_t());
+//
+// JavaRef works wherever JavaObj does as an argument and as a return type.
+template <JavaOwnership Ownership>
+class JavaRef {
+    jobject objId = nullptr;
+    JavaClassEntry* classEntry = nullptr;
+
+public:
+    JavaRef() = default;
+
+    // A type-only handle, to pass as the return type of a call.
+    explicit JavaRef(JavaClassEntry& classEntry) : classEntry(&classEntry) {
+    }
+
+    explicit JavaRef(const JavaClass& type) : classEntry(&type.getClassEntry()) {
+    }
+
+    // Takes over a local reference, e.g. a call result: a local handle keeps
+    // it, the others replace it with a reference of their own kind.
+    JavaRef(JavaClassEntry& classEntry, jobject local, JNIEnv* env) : classEntry(&classEntry) {
+        if constexpr (Ownership == JavaOwnership::Local) {
+            objId = local;
+        } else if (local != nullptr) {
+            objId = newRef(local, env);
+            env->DeleteLocalRef(local);
+        }
+    }
+
+    // A new reference to the object a JavaObj refers to.
+    explicit JavaRef(const JavaObj& object, JNIEnv* env = JavaEnv::get())
+        : objId(object.getObjId() == nullptr ? nullptr : newRef(object.getObjId(), env)), classEntry(&object.getClassEntry()) {
+    }
+
+    JavaRef(const JavaRef& other)
+        : objId(other.objId == nullptr ? nullptr : newRef(other.objId, JavaEnv::get())), classEntry(other.classEntry) {
+    }
+
+    JavaRef(JavaRef&& other) noexcept : objId(std::exchange(other.objId, nullptr)), classEntry(other.classEntry) {
+    }
+
+    JavaRef& operator=(JavaRef other) noexcept {
+        std::swap(objId, other.objId);
+        std::swap(classEntry, other.classEntry);
+        return *this;
+    }
+
+    ~JavaRef() {
+        reset();
+    }
+
+    jobject get() const {
+        return objId;
+    }
+
+    explicit operator bool() const {
+        return objId != nullptr;
+    }
+
+    JavaClassEntry& getClassEntry() const {
+        return *classEntry;
+    }
+
+    const std::string& getClassPath() const {
+        return classEntry->classPath;
+    }
+
+    // Gives up ownership and returns the raw reference.
+    jobject release() {
+        return std::exchange(objId, nullptr);
+    }
+
+    void reset() {
+        if (objId == nullptr) {
+            return;
+        }
+        if (auto env = JavaEnv::tryGet()) {
+            if constexpr (Ownership == JavaOwnership::Local) {
+                env->DeleteLocalRef(objId);
+            } else if constexpr (Ownership == JavaOwnership::Global) {
+                env->DeleteGlobalRef(objId);
+            } else {
+                env->DeleteWeakGlobalRef(static_cast<jweak>(objId));
+            }
+        }
+        objId = nullptr;
+    }
+
+    // A JavaObj over the referenced object, to call its methods; it borrows
+    // the reference and must not outlive this handle.
+    JavaObj object() const requires (Ownership != JavaOwnership::WeakGlobal) {
+        auto env = JavaEnv::get();
+        return JavaObj(*classEntry, objId, env);
+    }
+
+    JavaRef<JavaOwnership::Local> toLocal() const {
+        return convert<JavaOwnership::Local>();
+    }
+
+    JavaRef<JavaOwnership::Global> toGlobal() const {
+        return convert<JavaOwnership::Global>();
+    }
+
+    JavaRef<JavaOwnership::WeakGlobal> toWeak() const {
+        return convert<JavaOwnership::WeakGlobal>();
+    }
+
+    // A local reference to the object, empty once it has been collected.
+    JavaRef<JavaOwnership::Local> lock() const requires (Ownership == JavaOwnership::WeakGlobal) {
+        return toLocal();
+    }
+
+private:
+    template <JavaOwnership>
+    friend class JavaRef;
+
+    static jobject newRef(jobject object, JNIEnv* env) {
+        if constexpr (Ownership == JavaOwnership::Local) {
+            return env->NewLocalRef(object);
+        } else if constexpr (Ownership == JavaOwnership::Global) {
+            return env->NewGlobalRef(object);
+        } else {
+            return env->NewWeakGlobalRef(object);
+        }
+    }
+
+    template <JavaOwnership Target>
+    JavaRef<Target> convert() const {
+        JavaRef<Target> converted(*classEntry);
+        if (objId != nullptr) {
+            converted.objId = JavaRef<Target>::newRef(objId, JavaEnv::get());
+        }
+        return converted;
+    }
+};
+
+using JavaLocalRef = JavaRef<JavaOwnership::Local>;
+using JavaGlobalRef = JavaRef<JavaOwnership::Global>;
+using JavaWeakRef = JavaRef<JavaOwnership::WeakGlobal>;
+
+template <JavaOwnership Ownership>
+struct JavaType<JavaRef<Ownership>> {
+    static void appendSymbol(std::string& buffer, const JavaRef<Ownership>& ref) {
+        buffer += 'L';
+        buffer += ref.getClassPath();
+        buffer += ';';
+    }
+};
@@ -0,0 +1,158 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaType.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// A java.lang.String held as a global reference for the life of the JVM.
+// Passing it as an argument costs nothing: no conversion, no local reference.
+class JavaInternedString {
+    jstring string;
+
+public:
+    explicit JavaInternedString(jstring string) : string(string) {
+    }
+
+    jstring get() const {
+        return string;
+    }
+};
+
+// Conversions between Java strings and C++ strings. Text is exchanged in the
+// JVM's modified UTF-8 (identical to UTF-8 for text without NUL characters or
+// code points above U+FFFF) or in UTF-16. Reads go straight into the
+// destination buffer through Get*Region, so nothing has to be released.
+class JavaString {
+public:
+    // Replaces the contents of out with the string; out keeps its capacity
+    // between calls, so a reused buffer stops allocating once it is big enough.
+    static void toUtf8(jstring string, std::string& out, JNIEnv* env) {
+        if (string == nullptr) {
+            out.clear();
+            return;
+        }
+        auto length = env->GetStringLength(string);
+        auto utfLength = env->GetStringUTFLength(string);
+        out.resize(static_cast<std::size_t>(utfLength));
+        env->GetStringUTFRegion(string, 0, length, out.data());
+    }
+
+    static std::string toUtf8(jstring string, JNIEnv* env) {
+        std::string out;
+        toUtf8(string, out, env);
+        return out;
+    }
+
+    // Converts into a thread-local buffer; the view is valid until the next
+    // toUtf8View on the same thread.
+    static std::string_view toUtf8View(jstring string, JNIEnv* env) {
+        thread_local std::string buffer;
+        toUtf8(string, buffer, env);
+        return buffer;
+    }
+
+    static void toUtf16(jstring string, std::u16string& out, JNIEnv* env) {
+        if (string == nullptr) {
+            out.clear();
+            return;
+        }
+        auto length = env->GetStringLength(string);
+        out.resize(static_cast<std::size_t>(length));
+        env->GetStringRegion(string, 0, length, reinterpret_cast<jchar*>(out.data()));
+    }
+
+    static std::u16string toUtf16(jstring string, JNIEnv* env) {
+        std::u16string out;
+        toUtf16(string, out, env);
+        return out;
+    }
+
+    // Returns a new local reference.
+    static jstring fromUtf8(const char* value, JNIEnv* env) {
+        return env->NewStringUTF(value);
+    }
+
+    // Returns a new local reference. NewStringUTF needs a terminator, so views
+    // are copied into a reused thread-local buffer first.
+    static jstring fromUtf8(std::string_view value, JNIEnv* env) {
+        thread_local std::string buffer;
+        buffer.assign(value);
+        return env->NewStringUTF(buffer.c_str());
+    }
+
+    // Returns a new local reference.
+    static jstring fromUtf16(std::u16string_view value, JNIEnv* env) {
+        return env->NewString(reinterpret_cast<const jchar*>(value.data()), static_cast<jsize>(value.size()));
+    }
+
+    // Returns the process-wide global reference for value, creating it on
+    // first use. Keep the result around for strings passed on hot paths; the
+    // lookup itself takes a lock.
+    static JavaInternedString intern(std::string_view value) {
+        auto& table = internTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        auto found = table.strings.find(value);
+        if (found != table.strings.end()) {
+            return JavaInternedString(found->second);
+        }
+        auto env = JavaEnv::get();
+        auto local = fromUtf8(value, env);
+        auto global = static_cast<jstring>(env->NewGlobalRef(local));
+        env->DeleteLocalRef(local);
+        table.strings.emplace(std::string(value), global);
+        return JavaInternedString(global);
+    }
+
+    // Deletes every interned string; must run before the JVM is destroyed.
+    static void clearInterned(JNIEnv* env) {
+        auto& table = internTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        for (auto& [value, string] : table.strings) {
+            env->DeleteGlobalRef(string);
+        }
+        table.strings.clear();
+    }
+
+private:
+    struct InternTable {
+        std::mutex mutex;
+        std::map<std::string, jstring, std::less<>> strings;
+    };
+
+    static InternTable& internTable() {
+        static InternTable table;
+        return table;
+    }
+};
+
+template <>
+struct JavaType<std::string_view> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+    static constexpr bool createsLocalRef = true;
+};
+
+template <>
+struct JavaType<const char*> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+    static constexpr bool createsLocalRef = true;
+};
+
+template <>
+struct JavaType<std::u16string> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+    static constexpr bool createsLocalRef = true;
+};
+
+template <>
+struct JavaType<std::u16string_view> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+    static constexpr bool createsLocalRef = true;
+};
+
+template <>
+struct JavaType<JavaInternedString> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+};
@@ -0,0 +1,247 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaClassRegistry.h>
+#include <jni++/JavaDirectBuffer.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaException.h>
+#include <jni++/JavaObj.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// One field of a struct schema: its Java name and the C++ member it maps to.
+template <typename S, typename F>
+struct JavaStructField {
+    const char* name;
+    F S::* member;
+};
+
+// The schema of a trivially copyable struct, given once as a specialization:
+//
+//     struct Tick {
+//         int64_t time;
+//         double price;
+//         int32_t size;
+//     };
+//
+//     template <>
+//     struct JavaStructSchema<Tick> {
+//         static constexpr auto fields = std::make_tuple(
+//             JavaStructField{"time", &Tick::time},
+//             JavaStructField{"price", &Tick::price},
+//             JavaStructField{"size", &Tick::size});
+//     };
+template <typename S>
+struct JavaStructSchema;
+
+// How a field type is read from a ByteBuffer: the Java type and the suffix of
+// its get/put accessors. Unsigned values come back as the signed Java type
+// of the same width.
+template <typename F>
+struct JavaStructFieldType;
+
+template <>
+struct JavaStructFieldType<bool> {
+    static constexpr char symbol = 'Z';
+    static constexpr const char* javaType = "boolean";
+    static constexpr const char* accessor = "";
+};
+
+template <>
+struct JavaStructFieldType<int8_t> {
+    static constexpr char symbol = 'B';
+    static constexpr const char* javaType = "byte";
+    static constexpr const char* accessor = "";
+};
+
+template <>
+struct JavaStructFieldType<uint8_t> : JavaStructFieldType<int8_t> {
+};
+
+template <>
+struct JavaStructFieldType<char16_t> {
+    static constexpr char symbol = 'C';
+    static constexpr const char* javaType = "char";
+    static constexpr const char* accessor = "Char";
+};
+
+template <>
+struct JavaStructFieldType<int16_t> {
+    static constexpr char symbol = 'S';
+    static constexpr const char* javaType = "short";
+    static constexpr const char* accessor = "Short";
+};
+
+template <>
+struct JavaStructFieldType<uint16_t> : JavaStructFieldType<int16_t> {
+};
+
+template <>
+struct JavaStructFieldType<int32_t> {
+    static constexpr char symbol = 'I';
+    static constexpr const char* javaType = "int";
+    static constexpr const char* accessor = "Int";
+};
+
+template <>
+struct JavaStructFieldType<uint32_t> : JavaStructFieldType<int32_t> {
+};
+
+template <>
+struct JavaStructFieldType<int64_t> {
+    static constexpr char symbol = 'J';
+    static constexpr const char* javaType = "long";
+    static constexpr const char* accessor = "Long";
+};
+
+template <>
+struct JavaStructFieldType<uint64_t> : JavaStructFieldType<int64_t> {
+};
+
+template <>
+struct JavaStructFieldType<float> {
+    static constexpr char symbol = 'F';
+    static constexpr const char* javaType = "float";
+    static constexpr const char* accessor = "Float";
+};
+
+template <>
+struct JavaStructFieldType<double> {
+    static constexpr char symbol = 'D';
+    static constexpr const char* javaType = "double";
+    static constexpr const char* accessor = "Double";
+};
+
+// Marshalling of the records of a JavaStructSchema. Records keep their C++
+// layout: a contiguous container of them is handed to Java as one
+// native-order direct ByteBuffer over its own memory, without copying, and
+// Java reads record i, field f at i * SIZE + offset of f. The offsets come
+// from layout(), from describe() at run time, or from the view class that
+// javaSource() generates.
+template <typename S>
+class JavaStruct {
+    static_assert(std::is_trivially_copyable_v<S> && std::is_standard_layout_v<S>, "struct records are shared with Java byte for byte");
+
+public:
+    struct Field {
+        std::string_view name;
+        std::size_t offset;
+        std::size_t size;
+        char symbol;
+        const char* javaType;
+        const char* accessor;
+    };
+
+    static constexpr std::size_t size = sizeof(S);
+
+    // The fields in schema order, with their byte offsets inside a record.
+    static const std::vector<Field>& layout() {
+        static const std::vector<Field> fields = std::apply([](const auto&... field) {
+            return std::vector<Field>{ describeField(field)... };
+        }, JavaStructSchema<S>::fields);
+        return fields;
+    }
+
+    // The layout as accessor metadata for Java code that is not generated:
+    // "size;name:symbol:offset,...", e.g. "24;time:J:0,price:D:8,size:I:16".
+    static std::string describe() {
+        std::string text = std::to_string(size) + ";";
+        bool first = true;
+        for (auto& field : layout()) {
+            text += first ? "" : ",";
+            text += field.name;
+            text += ':';
+            text += field.symbol;
+            text += ':';
+            text += std::to_string(field.offset);
+            first = false;
+        }
+        return text;
+    }
+
+    // Source of a Java flyweight over a records buffer, with one getter and
+    // setter per field:
+    //
+    //     var ticks = new TickView(buffer);
+    //     for (int i = 0; i < ticks.count(); ++i) {
+    //         total += ticks.at(i).price();
+    //     }
+    static std::string javaSource(std::string_view packageName, std::string_view className) {
+        std::string source;
+        if (!packageName.empty()) {
+            source += "package ";
+            source += packageName;
+            source += ";\n\n";
+        }
+        source += "import java.nio.ByteBuffer;\nimport java.nio.ByteOrder;\n\n";
+        source += "// Generated from JavaStructSchema; records are in native byte order.\n";
+        source += "public final class ";
+        source += className;
+        source += " {\n    public static final int SIZE = " + std::to_string(size) + ";\n";
+        for (auto& field : layout()) {
+            source += "    public static final int " + constantName(field.name) + " = " + std::to_string(field.offset) + ";\n";
+        }
+        source += "\n    private final ByteBuffer buffer;\n    private int base;\n\n";
+        source += "    public ";
+        source += className;
+        source += "(ByteBuffer buffer) {\n        this.buffer = buffer.duplicate().order(ByteOrder.nativeOrder());\n    }\n\n";
+        source += "    public int count() {\n        return buffer.capacity() / SIZE;\n    }\n\n";
+        source += "    public ";
+        source += className;
+        source += " at(int index) {\n        base = index * SIZE;\n        return this;\n    }\n";
+        for (auto& field : layout()) {
+            auto offset = "base + " + constantName(field.name);
+            std::string name(field.name);
+            source += "\n    public " + std::string(field.javaType) + " " + name + "() {\n        return ";
+            if (field.symbol == 'Z') {
+                source += "buffer.get(" + offset + ") != 0";
+            } else {
+                source += "buffer.get" + std::string(field.accessor) + "(" + offset + ")";
+            }
+            source += ";\n    }\n\n    public void " + name + "(" + field.javaType + " value) {\n        ";
+            if (field.symbol == 'Z') {
+                source += "buffer.put(" + offset + ", (byte) (value ? 1 : 0))";
+            } else {
+                source += "buffer.put" + std::string(field.accessor) + "(" + offset + ", value)";
+            }
+            source += ";\n    }\n";
+        }
+        source += "}\n";
+        return source;
+    }
+
+    // The records as a native-order ByteBuffer over the container's memory,
+    // taken from JavaDirectBufferPool. Java writes go straight to the records.
+    template <typename Container>
+    static JavaObj buffer(const Container& records, JNIEnv* env = JavaEnv::get()) {
+        static_assert(std::is_same_v<std::remove_cv_t<typename Container::value_type>, S>, "the container does not hold records of this schema");
+        auto view = JavaDirectBufferPool::getInstance().get(records.data(), records.size(), env);
+        JavaException::check("JavaStruct::buffer JavaDirectBufferPool", env);
+        return JavaObj(JavaClassRegistry::getInstance().get("java/nio/ByteBuffer"), view, env);
+    }
+
+private:
+    template <typename F>
+    static Field describeField(const JavaStructField<S, F>& field) {
+        using Type = JavaStructFieldType<F>;
+        static const S sample{};
+        auto offset = reinterpret_cast<const std::byte*>(&(sample.*field.member)) - reinterpret_cast<const std::byte*>(&sample);
+        return Field{field.name, static_cast<std::size_t>(offset), sizeof(F), Type::symbol, Type::javaType, Type::accessor};
+    }
+
+    static std::string constantName(std::string_view name) {
+        std::string constant = "OFFSET_";
+        for (std::size_t i = 0; i < name.size(); ++i) {
+            auto c = name[i];
+            if (c >= 'A' && c <= 'Z' && i > 0) {
+                constant += '_';
+            }
+            constant += static_cast<char>(c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+        }
+        return constant;
+    }
+};
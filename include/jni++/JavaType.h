@@ -0,0 +1,201 @@
+#pragma once
+#include <jni.h>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+// Null-terminated string whose length is part of its type, so JNI descriptors
+// can be assembled by the compiler instead of at every call.
+template <std::size_t N>
+struct JavaFixedString {
+    char data[N + 1] = {};
+
+    constexpr JavaFixedString() = default;
+
+    constexpr JavaFixedString(const char (&str)[N + 1]) {
+        for (std::size_t i = 0; i < N; ++i) {
+            data[i] = str[i];
+        }
+    }
+
+    template <std::size_t M>
+    constexpr JavaFixedString<N + M> operator+(const JavaFixedString<M>& other) const {
+        JavaFixedString<N + M> result;
+        for (std::size_t i = 0; i < N; ++i) {
+            result.data[i] = data[i];
+        }
+        for (std::size_t i = 0; i < M; ++i) {
+            result.data[N + i] = other.data[i];
+        }
+        return result;
+    }
+
+    constexpr std::size_t size() const {
+        return N;
+    }
+
+    constexpr const char* c_str() const {
+        return data;
+    }
+
+    constexpr operator std::string_view() const {
+        return std::string_view(data, N);
+    }
+};
+
+template <std::size_t N>
+JavaFixedString(const char (&)[N]) -> JavaFixedString<N - 1>;
+
+// Maps a C++ type to its JNI descriptor. Types with a descriptor known at
+// compile time expose a constexpr `symbol`; types whose descriptor depends on
+// the value (JavaObj carries its class path at runtime) expose `appendSymbol`.
+template <typename T, typename = void>
+struct JavaType;
+
+template <typename T>
+using JavaTypeOf = JavaType<std::remove_cv_t<std::remove_reference_t<T>>>;
+
+template <typename T, typename = void>
+struct JavaHasStaticSymbol : std::false_type {};
+
+template <typename T>
+struct JavaHasStaticSymbol<T, std::void_t<decltype(JavaTypeOf<T>::symbol)>> : std::true_type {};
+
+// True when T crosses the boundary by value, so the Java reference made for
+// it (an argument built from it, or a returned object converted to it) is a
+// temporary that the library deletes once the call is done.
+template <typename T, typename = void>
+struct JavaCreatesLocalRef : std::false_type {};
+
+template <typename T>
+struct JavaCreatesLocalRef<T, std::enable_if_t<JavaTypeOf<T>::createsLocalRef>> : std::true_type {};
+
+template <>
+struct JavaType<void> {
+    static constexpr JavaFixedString symbol{"V"};
+};
+
+template <>
+struct JavaType<bool> {
+    static constexpr JavaFixedString symbol{"Z"};
+};
+
+template <>
+struct JavaType<uint8_t> {
+    static constexpr JavaFixedString symbol{"S"};
+};
+
+template <>
+struct JavaType<int8_t> {
+    static constexpr JavaFixedString symbol{"C"};
+};
+
+template <>
+struct JavaType<int16_t> {
+    static constexpr JavaFixedString symbol{"S"};
+};
+
+template <>
+struct JavaType<int32_t> {
+    static constexpr JavaFixedString symbol{"I"};
+};
+
+template <typename T>
+struct JavaType<T, std::enable_if_t<std::is_same_v<T, long> && !std::is_same_v<long, int32_t> && !std::is_same_v<long, int64_t>>> {
+    static constexpr JavaFixedString symbol{"I"};
+};
+
+template <>
+struct JavaType<uint16_t> {
+    static constexpr JavaFixedString symbol{"I"};
+};
+
+template <>
+struct JavaType<uint32_t> {
+    static constexpr JavaFixedString symbol{"J"};
+};
+
+template <>
+struct JavaType<int64_t> {
+    static constexpr JavaFixedString symbol{"J"};
+};
+
+template <>
+struct JavaType<float> {
+    static constexpr JavaFixedString symbol{"F"};
+};
+
+template <>
+struct JavaType<double> {
+    static constexpr JavaFixedString symbol{"D"};
+};
+
+template <>
+struct JavaType<std::string> {
+    static constexpr JavaFixedString symbol{"Ljava/lang/String;"};
+    static constexpr bool createsLocalRef = true;
+};
+
+template <typename ReturnType, typename... Args>
+struct JavaSignature {
+    static constexpr bool isStatic = JavaHasStaticSymbol<ReturnType>::value && (JavaHasStaticSymbol<Args>::value && ...);
+
+    // Returns the method descriptor. The view is always null-terminated; when
+    // an argument type has no static symbol it points into a thread-local
+    // buffer that is only valid until the next signature built on this thread.
+    static std::string_view get(const ReturnType* returnType, const Args&... args) {
+        if constexpr (isStatic) {
+            return value();
+        } else {
+            thread_local std::string buffer;
+            buffer.clear();
+            buffer += '(';
+            (append(buffer, args), ...);
+            buffer += ')';
+            if constexpr (JavaHasStaticSymbol<ReturnType>::value) {
+                buffer += std::string_view(JavaTypeOf<ReturnType>::symbol);
+            } else {
+                JavaTypeOf<ReturnType>::appendSymbol(buffer, *returnType);
+            }
+            return buffer;
+        }
+    }
+
+    // Descriptor of a signature made only of types with a static symbol.
+    static std::string_view get() requires isStatic {
+        return value();
+    }
+
+private:
+    static std::string_view value() {
+        static constexpr auto descriptor = (JavaFixedString{"("} + ... + JavaTypeOf<Args>::symbol) + JavaFixedString{")"} + JavaTypeOf<ReturnType>::symbol;
+        return descriptor;
+    }
+
+    template <typename Arg>
+    static void append(std::string& buffer, const Arg& arg) {
+        if constexpr (JavaHasStaticSymbol<Arg>::value) {
+            buffer += std::string_view(JavaTypeOf<Arg>::symbol);
+        } else {
+            JavaTypeOf<Arg>::appendSymbol(buffer, arg);
+        }
+    }
+};
+
+// Field descriptor of T. A descriptor that depends on the value is built in a
+// thread-local buffer, valid until the next one built on this thread.
+template <typename T>
+struct JavaDescriptor {
+    static std::string_view get(const T& value) {
+        if constexpr (JavaHasStaticSymbol<T>::value) {
+            return JavaTypeOf<T>::symbol;
+        } else {
+            thread_local std::string buffer;
+            buffer.clear();
+            JavaTypeOf<T>::appendSymbol(buffer, value);
+            return buffer;
+        }
+    }
+};
@@ -0,0 +1,382 @@
+#pragma once
+#include <jni.h>
+#include <jni++/JavaEnv.h>
+#include <jni++/JavaLocalFrame.h>
+#include <jni++/JavaObj.h>
+#include <jni++/JavaRef.h>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Worker threads attached to the JVM that run Java calls off the caller's
+// thread. Each worker owns a queue and steals from the others when its own is
+// empty. With maxBatch > 1, queued calls to the same method are taken together
+// and run back to back inside one local frame.
+//
+//     JavaWorkerPool pool(4);
+//     std::future<int32_t> sum = pool.call(obj, "sum", int32_t(), 1, 2);
+//     int32_t product = co_await pool.async(obj, "product", int32_t(), 3, 4);
+//
+// Every task runs inside a JavaLocalFrame. Objects passed in are shared as
+// global references first and views are copied, and JavaObj results come
+// back shared, so both are safe to use on any thread. The pool must be destroyed before the JVM.
+class JavaWorkerPool {
+    struct Task {
+        std::string batchKey;
+        std::function<void()> run;
+        // Resumed after the batch's local frame is popped.
+        std::coroutine_handle<> continuation;
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::size_t maxBatch;
+    std::atomic<std::size_t> nextWorker{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    std::size_t pending = 0;
+    bool stopping = false;
+
+public:
+    explicit JavaWorkerPool(std::size_t threadCount = std::thread::hardware_concurrency(), std::size_t maxBatch = 1)
+        : maxBatch(maxBatch == 0 ? 1 : maxBatch) {
+        threadCount = threadCount == 0 ? 1 : threadCount;
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            threads.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    JavaWorkerPool(JavaWorkerPool const&) = delete;
+    JavaWorkerPool& operator=(JavaWorkerPool const&) = delete;
+
+    // Runs what is already queued, then joins the workers, which detach from the JVM.
+    ~JavaWorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    std::size_t size() const {
+        return threads.size();
+    }
+
+    // Runs function on a worker; its result or exception ends up in the future.
+    template <typename Function>
+    auto submit(Function&& function) {
+        using Result = std::invoke_result_t<std::decay_t<Function>&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+        auto future = task->get_future();
+        post(std::string(), [task] { (*task)(); });
+        return future;
+    }
+
+    // Calls the method on a worker. Instance calls take a JavaObj, static ones a JavaClass.
+    template <typename Target, typename ReturnType, typename... Args>
+    std::future<ReturnType> call(const Target& target, std::string_view name, const ReturnType& returnType, Args&&... args) {
+        auto task = std::make_shared<std::packaged_task<ReturnType()>>(bindCall(target, name, returnType, std::forward<Args>(args)...));
+        auto future = task->get_future();
+        post(batchKey(target, name), [task] { (*task)(); });
+        return future;
+    }
+
+    template <typename Target, typename... Args>
+    std::future<void> callVoid(const Target& target, std::string_view name, Args&&... args) {
+        auto task = std::make_shared<std::packaged_task<void()>>(bindCallVoid(target, name, std::forward<Args>(args)...));
+        auto future = task->get_future();
+        post(batchKey(target, name), [task] { (*task)(); });
+        return future;
+    }
+
+    // Awaitable for C++20 coroutines. The coroutine resumes on the worker
+    // thread once the call's batch is done, outside its local frame; keep only
+    // shared references across the co_await.
+    template <typename Result>
+    class Awaitable {
+        JavaWorkerPool* pool;
+        std::string batchKey;
+        std::function<Result()> function;
+        std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> result{};
+        std::exception_ptr error;
+
+    public:
+        Awaitable(JavaWorkerPool* pool, std::string batchKey, std::function<Result()> function)
+            : pool(pool), batchKey(std::move(batchKey)), function(std::move(function)) {
+        }
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool->post(std::move(batchKey), [this, handle] {
+                try {
+                    if constexpr (std::is_void_v<Result>) {
+                        function();
+                    } else {
+                        result.emplace(function());
+                    }
+                } catch (...) {
+                    error = std::current_exception();
+                }
+            }, handle);
+        }
+
+        Result await_resume() {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+            if constexpr (!std::is_void_v<Result>) {
+                return std::move(*result);
+            }
+        }
+    };
+
+    template <typename Function>
+    auto async(Function&& function) {
+        using Result = std::invoke_result_t<std::decay_t<Function>&>;
+        return Awaitable<Result>(this, std::string(), std::forward<Function>(function));
+    }
+
+    template <typename Target, typename ReturnType, typename... Args>
+    Awaitable<ReturnType> async(const Target& target, std::string_view name, const ReturnType& returnType, Args&&... args) {
+        return Awaitable<ReturnType>(this, batchKey(target, name), bindCall(target, name, returnType, std::forward<Args>(args)...));
+    }
+
+    template <typename Target, typename... Args>
+    Awaitable<void> asyncVoid(const Target& target, std::string_view name, Args&&... args) {
+        return Awaitable<void>(this, batchKey(target, name), bindCallVoid(target, name, std::forward<Args>(args)...));
+    }
+
+private:
+    template <typename T>
+    struct IsArray : std::false_type {};
+
+    template <typename T>
+    struct IsArray<JavaArray<T>> : std::true_type {};
+
+    template <typename T>
+    struct IsSpan : std::false_type {};
+
+    template <typename T, std::size_t Extent>
+    struct IsSpan<std::span<T, Extent>> : std::true_type {};
+
+    // A JavaArray argument held through a global reference until the task has run.
+    template <typename Array>
+    struct SharedArray {
+        std::shared_ptr<std::remove_pointer_t<jobject>> ref;
+    };
+
+    // The values of a span argument, copied.
+    template <typename T>
+    struct SharedSpan {
+        std::vector<T> values;
+    };
+
+    // Arguments are made safe to use on a worker, whenever the task runs:
+    // JavaObj handles and local JavaRefs become global references, JavaArray
+    // arguments are held through one, and C strings and views are copied
+    // into owning strings and vectors.
+    template <typename T>
+    static auto shared(const T& value) {
+        using Type = std::decay_t<T>;
+        static_assert(!std::is_same_v<Type, jobject>, "JavaWorkerPool: pass a JavaObj or a JavaGlobalRef rather than a raw jobject");
+        if constexpr (std::is_base_of_v<JavaObj, Type>) {
+            return value.getObjId() == nullptr ? value : value.share();
+        } else if constexpr (std::is_same_v<Type, JavaLocalRef>) {
+            return value.toGlobal();
+        } else if constexpr (IsArray<Type>::value) {
+            auto global = value.getObjId() == nullptr ? nullptr : JavaEnv::get()->NewGlobalRef(value.getObjId());
+            return SharedArray<Type>{std::shared_ptr<std::remove_pointer_t<jobject>>(global, [](jobject ref) {
+                auto env = ref == nullptr ? nullptr : JavaEnv::tryGet();
+                if (env != nullptr) {
+                    env->DeleteGlobalRef(ref);
+                }
+            })};
+        } else if constexpr (std::is_same_v<Type, const char*> || std::is_same_v<Type, char*> || std::is_same_v<Type, std::string_view>) {
+            return std::string(value);
+        } else if constexpr (std::is_same_v<Type, std::u16string_view>) {
+            return std::u16string(value);
+        } else if constexpr (IsSpan<Type>::value) {
+            return SharedSpan<std::remove_const_t<typename Type::element_type>>{{value.begin(), value.end()}};
+        } else {
+            return Type(value);
+        }
+    }
+
+    // The argument as passed to the call on the worker.
+    template <typename T>
+    static const T& unwrap(const T& value) {
+        return value;
+    }
+
+    template <typename Array>
+    static Array unwrap(const SharedArray<Array>& array) {
+        return Array(array.ref.get());
+    }
+
+    template <typename T>
+    static std::span<const T> unwrap(const SharedSpan<T>& span) {
+        return span.values;
+    }
+
+    // Results leave the worker's local frame: JavaObj results are shared, and
+    // bindCall rejects types that would carry a worker-local reference.
+    template <typename T>
+    static T shareResult(T value) {
+        if constexpr (std::is_base_of_v<JavaObj, T>) {
+            return value.share();
+        } else {
+            return value;
+        }
+    }
+
+    template <typename Target, typename ReturnType, typename... Args>
+    static auto bindCall(const Target& target, std::string_view name, const ReturnType& returnType, Args&&... args) {
+        static_assert(!std::is_same_v<ReturnType, JavaLocalRef>, "JavaWorkerPool: return a JavaGlobalRef; a local reference dies with the worker's frame");
+        static_assert(!std::is_same_v<ReturnType, jobject> && !IsArray<ReturnType>::value, "JavaWorkerPool: a raw jobject or JavaArray result dies with the worker's frame; return a JavaObj or JavaGlobalRef, or copy the array out inside submit()");
+        return [target = shared(target), name = std::string(name), returnType = shared(returnType), args = std::make_tuple(shared(args)...)]() mutable {
+            return std::apply([&](auto&... values) {
+                return shareResult(target.call(name, returnType, unwrap(values)...));
+            }, args);
+        };
+    }
+
+    template <typename Target, typename... Args>
+    static auto bindCallVoid(const Target& target, std::string_view name, Args&&... args) {
+        return [target = shared(target), name = std::string(name), args = std::make_tuple(shared(args)...)]() mutable {
+            std::apply([&](auto&... values) {
+                target.callVoid(name, unwrap(values)...);
+            }, args);
+        };
+    }
+
+    std::string batchKey(const JavaClass& target, std::string_view name) const {
+        if (maxBatch == 1) {
+            return std::string();
+        }
+        std::string key = target.getClassPath();
+        key += '.';
+        key += name;
+        return key;
+    }
+
+    struct WorkerIdentity {
+        JavaWorkerPool* pool = nullptr;
+        std::size_t index = 0;
+    };
+
+    static WorkerIdentity& currentWorker() {
+        thread_local WorkerIdentity identity;
+        return identity;
+    }
+
+    // Tasks posted from a worker stay on its own queue; others are spread round-robin.
+    // pending is counted before the task becomes visible, so a worker that takes
+    // it right away never decrements below zero.
+    void post(std::string batchKey, std::function<void()> run, std::coroutine_handle<> continuation = {}) {
+        auto& self = currentWorker();
+        auto index = self.pool == this ? self.index : nextWorker.fetch_add(1, std::memory_order_relaxed) % workers.size();
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            ++pending;
+        }
+        {
+            std::lock_guard<std::mutex> lock(workers[index]->mutex);
+            workers[index]->tasks.push_back(Task{std::move(batchKey), std::move(run), continuation});
+        }
+        wake.notify_one();
+    }
+
+    // Takes the next task from the front of the worker's own queue, plus any
+    // directly following tasks for the same method, up to maxBatch.
+    bool takeOwn(std::size_t index, std::vector<Task>& batch) {
+        auto& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            return false;
+        }
+        batch.push_back(std::move(worker.tasks.front()));
+        worker.tasks.pop_front();
+        auto& key = batch.front().batchKey;
+        while (!key.empty() && batch.size() < maxBatch && !worker.tasks.empty() && worker.tasks.front().batchKey == key) {
+            batch.push_back(std::move(worker.tasks.front()));
+            worker.tasks.pop_front();
+        }
+        return true;
+    }
+
+    bool steal(std::size_t thief, std::vector<Task>& batch) {
+        for (std::size_t offset = 1; offset < workers.size(); ++offset) {
+            auto& victim = *workers[(thief + offset) % workers.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                batch.push_back(std::move(victim.tasks.back()));
+                victim.tasks.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void work(std::size_t index) {
+        currentWorker() = WorkerIdentity{this, index};
+        std::vector<Task> batch;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(sleepMutex);
+                wake.wait(lock, [this] { return pending > 0 || stopping; });
+                if (pending == 0 && stopping) {
+                    return;
+                }
+            }
+            batch.clear();
+            if (!takeOwn(index, batch) && !steal(index, batch)) {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                pending -= batch.size();
+            }
+            {
+                JavaLocalFrame frame(static_cast<jint>(16 * batch.size()));
+                for (auto& task : batch) {
+                    task.run();
+                }
+            }
+            for (auto& task : batch) {
+                if (task.continuation) {
+                    task.continuation.resume();
+                }
+            }
+        }
+    }
+};